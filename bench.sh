@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Usage: ./bench.sh [SCRIPT...]
+# Runs each script RUNS times with LIZYLANG and prints the best time in ms.
+# LIZYLANG="./main -t" measures the tree walker instead of the bytecode.
+# ./bench.sh --parse [MB] generates a script of about MB megabytes of
+# comments, and prints how fast it is parsed.
+# ./bench.sh --startup [MB] runs the same script without and with the
+# parsed code saved in a .lzyc file.
+# ./bench.sh --print [N] prints N integers and floats.
+
+LIZYLANG=${LIZYLANG:-./main}
+RUNS=${RUNS:-3}
+
+# Prints the best time of RUNS runs of a script in ms.
+measure() {
+    best=
+    for i in $(seq $RUNS); do
+        start=$(date +%s%N)
+        echo | $LIZYLANG "$@" > /dev/null
+        end=$(date +%s%N)
+        ms=$(((end-start)/1000000))
+        if [ -z "$best" ] || [ $ms -lt $best ]; then
+            best=$ms
+        fi
+    done
+    echo $best
+}
+
+# Generates a script of about $1 MB of comments in $2.
+generate() {
+    awk -v mb="$1" 'BEGIN {
+        line = "(comment \"A comment that is long enough to be a few " \
+               "chunks,\\nwith an escape and a\n" \
+               "newline.\" some names and 12.5 numbers (nested call))"
+        for(n = 0; n < mb*1048576; n += length(line)+1) print line
+    }' > "$2"
+}
+
+if [ "$1" = "--parse" ]; then
+    mb=${2:-8}
+    script=$(mktemp)
+    generate $mb $script
+    best=$(measure -n $script)
+    echo "$script: $best ms"
+    [ "$best" -gt 0 ] && echo "Parsed $((mb*1000/best)) MB/s"
+    rm -f $script
+    exit
+fi
+
+if [ "$1" = "--startup" ]; then
+    mb=${2:-8}
+    script=$(mktemp --suffix .lzy)
+    generate $mb $script
+    echo "Without the saved code: $(measure -n $script) ms"
+    # The first run saves the parsed code.
+    echo | $LIZYLANG $script > /dev/null
+    echo "With the saved code: $(measure $script) ms"
+    rm -f $script ${script}c
+    exit
+fi
+
+if [ "$1" = "--print" ]; then
+    n=${2:-1000000}
+    script=$(mktemp --suffix .lzy)
+    echo "(fncdef loop (params i x)
+    (print i)
+    (print x)
+    (if (< i $((n/2))) (loop (+ i 1) (+ x 0.37)) i)
+)
+(loop 1 0.5)" > $script
+    echo "Printed $n numbers: $(measure -n $script) ms"
+    rm -f $script
+    exit
+fi
+
+if [ $# -eq 0 ]; then
+    set -- test/lazy.lzy test/factorial.lzy test/gameoflife.lzy
+fi
+
+for script in "$@"; do
+    echo "$script: $(measure $script) ms"
+done
@@ -1,4 +1,8 @@
 #!/bin/bash
 
+# The options are passed to the compiler, -DTL_FIXED=16 uses fixed point
+# numbers with 16 bits after the point instead of floats.
+
 cc src/main.c src/lisp.c src/var.c src/platform.c src/call.c src/builtin.c \
-   src/tree.c -o main -ansi -Isrc -g -Wall -Wextra -Wpedantic -lm
\ No newline at end of file
+   src/tree.c src/table.c src/symbol.c src/bytecode.c src/compile.c \
+   src/vm.c src/lex.c src/program.c src/optimize.c src/number.c -o main -ansi -Isrc -g -Wall -Wextra -Wpedantic -lm "$@"
\ No newline at end of file
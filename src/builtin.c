@@ -48,57 +48,73 @@
  * 2024/10/19: Updated some functions. Removed defend.
  * 2024/10/20: Finish user function definition.
  * 2024/10/21: Fixed functions.
+ * 2026/10/18: Get the arguments with call_get_arg in all the functions.
+ *             Rewrote callif. Use the symbols of the names. Cache the
+ *             function called by callif. Resolve the parameters when
+ *             defining a function. Tail calls through if and callif. Tell
+ *             the evaluator which arguments it evaluates before calling
+ *             the builtins. get shares the data of the list. Move the
+ *             values instead of copying them. Fold the calls of the
+ *             body of a function when it is defined. Integers, with the
+ *             operations on two of them done without floats. The floats
+ *             are computed and printed depending on their type. print
+ *             and printraw write to the buffered output, with the
+ *             shortest strings of the numbers. Added numstr. input
+ *             reads from the buffered input and stops at its end. Added
+ *             lines. strdef and numdef free their arguments on errors.
  */
 
 #include <builtin.h>
+#include <optimize.h>
 
-#define TL_REGISTER_FUNC(s, parse, f) rc = var_raw_str(&name, s, \
-                                                       sizeof(s)-1); \
-                                      if(rc) return rc; \
-                                      rc = var_builtin_func(&var, f, parse); \
-                                      if(rc) return rc; \
-                                      rc = tl_add_var(lisp, &var, &name); \
-                                      if(rc) return rc
+#define TL_REGISTER_FUNC(s, eval, f) rc = tl_intern(lisp, s, sizeof(s)-1, \
+                                                    &symbol); \
+                                     if(rc) return rc; \
+                                     rc = var_builtin_func(&var, f, eval); \
+                                     if(rc) return rc; \
+                                     rc = tl_move_var(lisp, &var, symbol); \
+                                     if(rc) return rc
 
 int builtin_register_funcs(LizyLang *lisp) {
     int rc;
     Var var;
-    String name;
+    size_t symbol;
     /* strdef */
-    TL_REGISTER_FUNC("strdef", 0, builtin_strdef);
-    TL_REGISTER_FUNC("numdef", 0, builtin_numdef);
-    TL_REGISTER_FUNC("set", 0, builtin_set);
-    TL_REGISTER_FUNC("del", 0, builtin_del);
+    TL_REGISTER_FUNC("strdef", TL_ARGS_NAME, builtin_strdef);
+    TL_REGISTER_FUNC("numdef", TL_ARGS_NAME, builtin_numdef);
+    TL_REGISTER_FUNC("set", TL_ARGS_NAME, builtin_set);
+    TL_REGISTER_FUNC("del", TL_ARGS_NAME, builtin_del);
     /* comment */
-    TL_REGISTER_FUNC("comment", 0, builtin_comment);
-    TL_REGISTER_FUNC("print", 1, builtin_print);
-    TL_REGISTER_FUNC("printraw", 0, builtin_printraw);
-    TL_REGISTER_FUNC("input", 1, builtin_input);
-    TL_REGISTER_FUNC("+", 1, builtin_add);
-    TL_REGISTER_FUNC("++", 1, builtin_merge);
-    TL_REGISTER_FUNC("params", 0, builtin_params);
-    TL_REGISTER_FUNC("list", 1, builtin_list);
-    TL_REGISTER_FUNC("fncdef", 0, builtin_fncdef);
-    TL_REGISTER_FUNC("if", 1, builtin_if);
-    TL_REGISTER_FUNC("<", 1, builtin_smaller);
-    TL_REGISTER_FUNC(">", 1, builtin_bigger);
-    TL_REGISTER_FUNC("<=", 1, builtin_smaller_or_equal);
-    TL_REGISTER_FUNC(">=", 1, builtin_bigger_or_equal);
-    TL_REGISTER_FUNC("=", 1, builtin_equal);
-    TL_REGISTER_FUNC("!=", 1, builtin_not_equal);
-    TL_REGISTER_FUNC("-", 1, builtin_substract);
-    TL_REGISTER_FUNC("*", 1, builtin_multiply);
-    TL_REGISTER_FUNC("/", 1, builtin_divide);
-    TL_REGISTER_FUNC("%", 1, builtin_modulo);
-    TL_REGISTER_FUNC("floor", 1, builtin_floor);
-    TL_REGISTER_FUNC("ceil", 1, builtin_ceil);
-    TL_REGISTER_FUNC("parsenum", 1, builtin_parsenum);
-    TL_REGISTER_FUNC("callif", 0, builtin_callif);
-    TL_REGISTER_FUNC("len", 1, builtin_len);
-    TL_REGISTER_FUNC("get", 1, builtin_get);
-    TL_REGISTER_FUNC("strlen", 1, builtin_strlen);
-    TL_REGISTER_FUNC("strget", 1, builtin_strget);
-    /* TODO: numstr: Convert float to string. */
+    TL_REGISTER_FUNC("comment", TL_ARGS_RAW, builtin_comment);
+    TL_REGISTER_FUNC("print", TL_ARGS_EVAL, builtin_print);
+    TL_REGISTER_FUNC("printraw", TL_ARGS_CALLS, builtin_printraw);
+    TL_REGISTER_FUNC("input", TL_ARGS_EVAL, builtin_input);
+    TL_REGISTER_FUNC("lines", TL_ARGS_EVAL, builtin_lines);
+    TL_REGISTER_FUNC("+", TL_ARGS_EVAL, builtin_add);
+    TL_REGISTER_FUNC("++", TL_ARGS_EVAL, builtin_merge);
+    TL_REGISTER_FUNC("params", TL_ARGS_RAW, builtin_params);
+    TL_REGISTER_FUNC("list", TL_ARGS_EVAL, builtin_list);
+    TL_REGISTER_FUNC("fncdef", TL_ARGS_RAW, builtin_fncdef);
+    TL_REGISTER_FUNC("if", TL_ARGS_FIRST, builtin_if);
+    TL_REGISTER_FUNC("<", TL_ARGS_EVAL, builtin_smaller);
+    TL_REGISTER_FUNC(">", TL_ARGS_EVAL, builtin_bigger);
+    TL_REGISTER_FUNC("<=", TL_ARGS_EVAL, builtin_smaller_or_equal);
+    TL_REGISTER_FUNC(">=", TL_ARGS_EVAL, builtin_bigger_or_equal);
+    TL_REGISTER_FUNC("=", TL_ARGS_EVAL, builtin_equal);
+    TL_REGISTER_FUNC("!=", TL_ARGS_EVAL, builtin_not_equal);
+    TL_REGISTER_FUNC("-", TL_ARGS_EVAL, builtin_substract);
+    TL_REGISTER_FUNC("*", TL_ARGS_EVAL, builtin_multiply);
+    TL_REGISTER_FUNC("/", TL_ARGS_EVAL, builtin_divide);
+    TL_REGISTER_FUNC("%", TL_ARGS_EVAL, builtin_modulo);
+    TL_REGISTER_FUNC("floor", TL_ARGS_EVAL, builtin_floor);
+    TL_REGISTER_FUNC("ceil", TL_ARGS_EVAL, builtin_ceil);
+    TL_REGISTER_FUNC("parsenum", TL_ARGS_EVAL, builtin_parsenum);
+    TL_REGISTER_FUNC("callif", TL_ARGS_FIRST, builtin_callif);
+    TL_REGISTER_FUNC("len", TL_ARGS_EVAL, builtin_len);
+    TL_REGISTER_FUNC("get", TL_ARGS_EVAL, builtin_get);
+    TL_REGISTER_FUNC("strlen", TL_ARGS_EVAL, builtin_strlen);
+    TL_REGISTER_FUNC("strget", TL_ARGS_EVAL, builtin_strget);
+    TL_REGISTER_FUNC("numstr", TL_ARGS_EVAL, builtin_numstr);
     /* TODO: head and tail */
     return TL_SUCCESS;
 }
@@ -119,42 +135,44 @@ int builtin_strdef(void *_lisp, void *_node, size_t argnum, void *_returned) {
     Node *node = _node;
     Var varname;
     Var value;
-    String name;
+    size_t symbol;
     int rc;
     TL_UNUSED(_node);
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
     rc = call_get_arg(lisp, node, 0, &varname, 0);
     if(rc) return rc;
+    if(varname.type != TL_T_NAME){
+        var_free(&varname);
+        return TL_ERR_BAD_TYPE;
+    }
+    if(VAR_LEN(&varname) != 1){
+        var_free(&varname);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
     rc = call_get_arg(lisp, node, 1, &value, 1);
     if(rc){
-        var_free(&value);
+        var_free(&varname);
         return rc;
     }
-    if(varname.type != TL_T_NAME) return TL_ERR_BAD_TYPE;
-    if(VAR_LEN(&varname) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    if(value.type != TL_T_STR) return TL_ERR_BAD_TYPE;
-    rc = var_raw_str(&name, VAR_STR_DATA(VAR_GET_ITEM(&varname, 0)),
-                     VAR_STR_LEN(VAR_GET_ITEM(&varname, 0)));
-    var_free(&varname);
-    if(rc){
+    if(value.type != TL_T_STR){
+        var_free(&varname);
         var_free(&value);
-        free(name.data);
-        return rc;
+        return TL_ERR_BAD_TYPE;
     }
-    rc = tl_add_var(lisp, &value, &name);
+    symbol = VAR_SYMBOL(VAR_GET_ITEM(&varname, 0));
+    var_free(&varname);
+    rc = var_copy(&value, _returned);
     if(rc){
         var_free(&value);
-        free(name.data);
         return rc;
     }
-    rc = var_copy(&value, _returned);
+    rc = tl_move_var(lisp, &value, symbol);
     if(rc){
         var_free(&value);
-        free(name.data);
-        return rc;
+        var_free(_returned);
     }
-    return TL_SUCCESS;
+    return rc;
 }
 
 int builtin_numdef(void *_lisp, void *_node, size_t argnum, void *_returned) {
@@ -162,62 +180,72 @@ int builtin_numdef(void *_lisp, void *_node, size_t argnum, void *_returned) {
     Node *node = _node;
     Var varname;
     Var value;
-    String name;
+    size_t symbol;
     int rc;
     TL_UNUSED(_node);
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
     rc = call_get_arg(lisp, node, 0, &varname, 0);
     if(rc) return rc;
+    if(varname.type != TL_T_NAME){
+        var_free(&varname);
+        return TL_ERR_BAD_TYPE;
+    }
+    if(VAR_LEN(&varname) != 1){
+        var_free(&varname);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
     rc = call_get_arg(lisp, node, 1, &value, 1);
     if(rc){
-        var_free(&value);
+        var_free(&varname);
         return rc;
     }
-    if(varname.type != TL_T_NAME) return TL_ERR_BAD_TYPE;
-    if(VAR_LEN(&varname) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    if(value.type != TL_T_NUM) return TL_ERR_BAD_TYPE;
-    rc = var_raw_str(&name, VAR_STR_DATA(VAR_GET_ITEM(&varname, 0)),
-                     VAR_STR_LEN(VAR_GET_ITEM(&varname, 0)));
-    var_free(&varname);
-    if(rc){
+    if(!VAR_IS_NUMBER(&value)){
+        var_free(&varname);
         var_free(&value);
-        free(name.data);
-        return rc;
+        return TL_ERR_BAD_TYPE;
     }
-    rc = tl_add_var(lisp, &value, &name);
+    symbol = VAR_SYMBOL(VAR_GET_ITEM(&varname, 0));
+    var_free(&varname);
+    rc = var_copy(&value, _returned);
     if(rc){
         var_free(&value);
-        free(name.data);
         return rc;
     }
-    rc = var_copy(&value, _returned);
+    rc = tl_move_var(lisp, &value, symbol);
     if(rc){
         var_free(&value);
-        free(name.data);
-        return rc;
+        var_free(_returned);
     }
-    return TL_SUCCESS;
+    return rc;
 }
 
 int builtin_set(void *_lisp, void *_node, size_t argnum, void *_returned) {
     LizyLang *lisp = _lisp;
-    Var *args = NULL; /* TODO: Fix required! */
+    Node *node = _node;
+    Var name;
     Var value;
     int rc;
-    TL_UNUSED(_node);
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(args[0].type != TL_T_NAME) return TL_ERR_BAD_TYPE;
-    if(VAR_LEN(args) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    rc = call_parse_arg(lisp, args+1, &value, lisp->stack_cur);
+    rc = call_get_arg(lisp, node, 0, &name, 0);
     if(rc) return rc;
-    rc = tl_set_var(lisp, &value, &args->items->string);
+    if(name.type != TL_T_NAME){
+        var_free(&name);
+        return TL_ERR_BAD_TYPE;
+    }
+    if(VAR_LEN(&name) != 1){
+        var_free(&name);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    rc = call_get_arg(lisp, node, 1, &value, 1);
     if(rc){
-        var_free(&value);
+        var_free(&name);
         return rc;
     }
-    rc = var_free(&value);
+    rc = tl_set_var(lisp, &value, VAR_ITEMS(&name)->symbol);
+    var_free(&name);
+    var_free(&value);
     if(rc) return rc;
     rc = var_num_from_float(_returned, 0);
     return rc;
@@ -225,62 +253,93 @@ int builtin_set(void *_lisp, void *_node, size_t argnum, void *_returned) {
 
 int builtin_del(void *_lisp, void *_node, size_t argnum,  void *_returned) {
     LizyLang *lisp = _lisp;
-    Var *args = NULL; /* TODO: Fix required! */
+    Node *node = _node;
+    Var name;
     int rc;
-    TL_UNUSED(_node);
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    if(args[0].type != TL_T_NAME) return TL_ERR_BAD_TYPE;
-    if(VAR_LEN(args) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    rc = tl_del_var(lisp, &args->items->string);
-    if(rc){
-        return rc;
+    rc = call_get_arg(lisp, node, 0, &name, 0);
+    if(rc) return rc;
+    if(name.type != TL_T_NAME){
+        var_free(&name);
+        return TL_ERR_BAD_TYPE;
     }
+    if(VAR_LEN(&name) != 1){
+        var_free(&name);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    rc = tl_del_var(lisp, VAR_ITEMS(&name)->symbol);
+    var_free(&name);
+    if(rc) return rc;
     rc = var_num_from_float(_returned, 0);
     return rc;
 }
 
+/* Writes an item of data to the output, with the names if raw is set. */
+int builtin_write_item(LizyLang *lisp, Var *data, size_t i, char raw) {
+    char num[NUMBER_STR_SZ];
+    String *name;
+    size_t len;
+    int rc;
+    switch(data->type){
+        case TL_T_STR:
+            if(VAR_LEN(data) > 1){
+                rc = tl_putc(lisp, '"');
+                if(rc) return rc;
+            }
+            rc = tl_write(lisp, VAR_STR_DATA(VAR_GET_ITEM(data, i)),
+                          VAR_STR_LEN(VAR_GET_ITEM(data, i)));
+            if(rc || VAR_LEN(data) < 2) return rc;
+            return tl_putc(lisp, '"');
+        case TL_T_NAME:
+            if(!raw) return TL_ERR_BAD_TYPE;
+            name = symbol_name(&lisp->symbols,
+                               VAR_SYMBOL(VAR_GET_ITEM(data, i)));
+            rc = tl_write(lisp, "<variable: ", 11);
+            if(!rc) rc = tl_write(lisp, name->data, name->len);
+            if(rc) return rc;
+            return tl_putc(lisp, '>');
+        case TL_T_NUM:
+            len = number_str(num, VAR_NUM(VAR_GET_ITEM(data, i)));
+            return tl_write(lisp, num, len);
+        case TL_T_INT:
+            len = number_int_str(num, VAR_INT(VAR_GET_ITEM(data, i)));
+            return tl_write(lisp, num, len);
+        default:
+            return TL_ERR_BAD_TYPE;
+    }
+}
+
+/* Writes data to the output, on a line, in parentheses if it is a list. */
+int builtin_write(LizyLang *lisp, Var *data, char raw) {
+    size_t i;
+    int rc = TL_SUCCESS;
+    if(VAR_LEN(data) < 1) return tl_write(lisp, "()\n", 3);
+    if(VAR_LEN(data) > 1) rc = tl_putc(lisp, '(');
+    for(i=0;!rc&&i<VAR_LEN(data);i++){
+        if(i) rc = tl_putc(lisp, ' ');
+        if(!rc) rc = builtin_write_item(lisp, data, i, raw);
+    }
+    if(!rc && VAR_LEN(data) > 1) rc = tl_putc(lisp, ')');
+    if(rc) return rc;
+    return tl_putc(lisp, '\n');
+}
+
 int builtin_print(void *_lisp, void *_node, size_t argnum, void *_returned) {
     LizyLang *lisp = _lisp;
     Node *node = _node;
     int rc;
-    size_t i;
     Var data;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
     rc = call_get_arg(lisp, node, 0, &data, 1);
     if(rc) return rc;
-    if(VAR_LEN(&data) < 1){
-        puts("()");
+    rc = builtin_write(lisp, &data, 0);
+    if(rc){
         var_free(&data);
-        return TL_SUCCESS;
-    }
-    if(VAR_LEN(&data) > 1) fputc('(', stdout);
-    for(i=0;i<VAR_LEN(&data);i++){
-        switch(data.type){
-            case TL_T_STR:
-                if(VAR_LEN(&data) > 1) fputc('"', stdout);
-                fwrite(VAR_STR_DATA(VAR_GET_ITEM(&data, i)), 1,
-                       VAR_STR_LEN(VAR_GET_ITEM(&data, i)), stdout);
-                if(VAR_LEN(&data) > 1) fputc('"', stdout);
-                if(i < VAR_LEN(&data)-1) fputc(' ', stdout);
-                break;
-            case TL_T_NUM:
-                /* TODO: Custom number conversion function. */
-                printf("%f", VAR_NUM(VAR_GET_ITEM(&data, i)));
-                if(i < VAR_LEN(&data)-1) fputc(' ', stdout);
-                break;
-            default:
-                var_free(&data);
-                return TL_ERR_BAD_TYPE;
-        }
+        return rc;
     }
-    if(VAR_LEN(&data) > 1) fputc(')', stdout);
-    fputc('\n', stdout);
-    rc = var_copy(&data, _returned);
-    var_free(&data);
-    if(rc) return rc;
-    return TL_SUCCESS;
+    return var_move(&data, _returned);
 }
 
 int builtin_printraw(void *_lisp, void *_node, size_t argnum,
@@ -288,59 +347,23 @@ int builtin_printraw(void *_lisp, void *_node, size_t argnum,
     LizyLang *lisp = _lisp;
     Node *node = _node;
     int rc;
-    size_t i;
     Var data;
-    TL_UNUSED(_lisp);
-    TL_UNUSED(_node);
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
     rc = call_get_arg(lisp, node, 0, &data, 0);
     if(rc) return rc;
-    if(VAR_LEN(&data) < 1){
-        puts("()");
+    rc = builtin_write(lisp, &data, 1);
+    if(rc){
         var_free(&data);
-        return TL_SUCCESS;
-    }
-    if(VAR_LEN(&data) > 1) fputc('(', stdout);
-    for(i=0;i<VAR_LEN(&data);i++){
-        switch(data.type){
-            case TL_T_STR:
-                if(VAR_LEN(&data) > 1) fputc('"', stdout);
-                fwrite(VAR_STR_DATA(VAR_GET_ITEM(&data, i)), 1,
-                       VAR_STR_LEN(VAR_GET_ITEM(&data, i)), stdout);
-                if(VAR_LEN(&data) > 1) fputc('"', stdout);
-                if(i < VAR_LEN(&data)-1) fputc(' ', stdout);
-                break;
-            case TL_T_NAME:
-                fputs("<variable: ", stdout);
-                fwrite(VAR_STR_DATA(VAR_GET_ITEM(&data, i)), 1,
-                       VAR_STR_LEN(VAR_GET_ITEM(&data, i)), stdout);
-                fputc('>', stdout);
-                if(i < VAR_LEN(&data)-1) fputc(' ', stdout);
-                break;
-            case TL_T_NUM:
-                /* TODO: Custom number conversion function. */
-                printf("%f", VAR_NUM(VAR_GET_ITEM(&data, i)));
-                if(i < VAR_LEN(&data)-1) fputc(' ', stdout);
-                break;
-            default:
-                var_free(&data);
-                return TL_ERR_BAD_TYPE;
-        }
+        return rc;
     }
-    if(VAR_LEN(&data) > 1) fputc(')', stdout);
-    fputc('\n', stdout);
-    rc = var_copy(&data, _returned);
-    var_free(&data);
-    if(rc) return rc;
-    return TL_SUCCESS;
+    return var_move(&data, _returned);
 }
 
 int builtin_input(void *_lisp, void *_node, size_t argnum, void *_returned) {
     LizyLang *lisp = _lisp;
     Node *node = _node;
     int rc;
-    char c;
     Var str;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
@@ -354,17 +377,60 @@ int builtin_input(void *_lisp, void *_node, size_t argnum, void *_returned) {
         var_free(&str);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    fwrite(VAR_STR_DATA(VAR_GET_ITEM(&str, 0)), 1,
-           VAR_STR_LEN(VAR_GET_ITEM(&str, 0)), stdout);
-    var_str(_returned, "", 0);
-    while((c = getc(stdin)) != '\n'){
-        rc = var_str_add(_returned, &c, 1);
+    /* The prompt is written before waiting for the input. */
+    rc = tl_write(lisp, VAR_STR_DATA(VAR_GET_ITEM(&str, 0)),
+                  VAR_STR_LEN(VAR_GET_ITEM(&str, 0)));
+    if(!rc) rc = tl_flush(lisp);
+    if(rc){
+        var_free(&str);
+        return rc;
+    }
+    var_free(&str);
+    return tl_read_line(lisp, _returned);
+}
+
+int builtin_lines(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
+    int rc;
+    TL_INT i, n;
+    Var num;
+    Var line;
+    if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
+    /* Without an argument, it reads the next line. */
+    if(!argnum) return tl_read_line(lisp, _returned);
+    rc = call_get_arg(lisp, node, 0, &num, 1);
+    if(rc) return rc;
+    if(!VAR_IS_NUMBER(&num)){
+        var_free(&num);
+        return TL_ERR_BAD_TYPE;
+    }
+    if(VAR_LEN(&num) != 1){
+        var_free(&num);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    n = VAR_INDEX(&num);
+    var_free(&num);
+    if(n < 0) return TL_ERR_OUT_OF_RANGE;
+    ((Var*)_returned)->null = 0;
+    ((Var*)_returned)->size = 0;
+    ((Var*)_returned)->items = NULL;
+    ((Var*)_returned)->type = TL_T_STR;
+    /* The list is shorter at the end of the input. */
+    for(i=0;i<n;i++){
+        rc = tl_read_line(lisp, &line);
         if(rc){
-            var_free(&str);
+            var_free(_returned);
+            return rc;
+        }
+        if(!VAR_LEN(&line)) break;
+        rc = var_append(&line, _returned);
+        var_free(&line);
+        if(rc){
+            var_free(_returned);
             return rc;
         }
     }
-    var_free(&str);
     return TL_SUCCESS;
 }
 
@@ -374,6 +440,7 @@ int builtin_add(void *_lisp, void *_node, size_t argnum, void *_returned) {
     int rc;
     Var a;
     Var b;
+    TL_INT x, y;
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
     rc = call_get_arg(lisp, node, 0, &a, 1);
@@ -383,7 +450,7 @@ int builtin_add(void *_lisp, void *_node, size_t argnum, void *_returned) {
         var_free(&a);
         return rc;
     }
-    else if(a.type != b.type){
+    else if(a.type != b.type && !(VAR_IS_NUMBER(&a) && VAR_IS_NUMBER(&b))){
         var_free(&a);
         var_free(&b);
         return TL_ERR_BAD_TYPE;
@@ -406,12 +473,17 @@ int builtin_add(void *_lisp, void *_node, size_t argnum, void *_returned) {
             if(rc) return rc;
             break;
         case TL_T_NUM:
-            rc = var_num_from_float(_returned, VAR_NUM(VAR_GET_ITEM(&a, 0))+
-                                    VAR_NUM(VAR_GET_ITEM(&b, 0)));
-            var_free(&a);
-            var_free(&b);
-            if(rc) return rc;
-            break;
+        case TL_T_INT:
+            /* The sum of two integers is an integer if it fits. */
+            if(a.type == TL_T_INT && b.type == TL_T_INT){
+                x = VAR_ITEMS(&a)->integer;
+                y = VAR_ITEMS(&b)->integer;
+                if(y > 0 ? x <= TL_INT_MAX-y : x >= TL_INT_MIN-y){
+                    return var_int(_returned, x+y);
+                }
+            }
+            return var_num_from_float(_returned, NUMBER_ADD(VAR_FLOAT(&a),
+                                                            VAR_FLOAT(&b)));
         default:
             var_free(&a);
             var_free(&b);
@@ -421,15 +493,25 @@ int builtin_add(void *_lisp, void *_node, size_t argnum, void *_returned) {
 }
 
 int builtin_merge(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    Var *args = NULL; /* TODO: Fix required! */
-    TL_UNUSED(_lisp);
+    Var list;
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    rc = var_copy(args, _returned);
-    if(rc) return rc;
-    rc = var_append(args+1, _returned);
+    rc = call_get_arg(lisp, node, 0, _returned, 1);
     if(rc) return rc;
+    rc = call_get_arg(lisp, node, 1, &list, 1);
+    if(rc){
+        var_free(_returned);
+        return rc;
+    }
+    rc = var_append(&list, _returned);
+    var_free(&list);
+    if(rc){
+        var_free(_returned);
+        return rc;
+    }
     return TL_SUCCESS;
 }
 
@@ -465,11 +547,11 @@ int builtin_params(void *_lisp, void *_node, size_t argnum, void *_returned) {
 }
 
 int builtin_list(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    Var *args = NULL; /* TODO: Fix required! */
+    Var item;
     size_t i;
-    TL_UNUSED(_lisp);
-    TL_UNUSED(_node);
     if(!argnum){
         ((Var*)_returned)->null = 0;
         ((Var*)_returned)->size = 0;
@@ -477,10 +559,16 @@ int builtin_list(void *_lisp, void *_node, size_t argnum, void *_returned) {
         ((Var*)_returned)->type = TL_T_NUM;
         return TL_SUCCESS;
     }
-    rc = var_copy(args, _returned);
+    rc = call_get_arg(lisp, node, 0, _returned, 1);
     if(rc) return rc;
     for(i=1;i<argnum;i++){
-        rc = var_append(args+i, _returned);
+        rc = call_get_arg(lisp, node, i, &item, 1);
+        if(rc){
+            var_free(_returned);
+            return rc;
+        }
+        rc = var_append(&item, _returned);
+        var_free(&item);
         if(rc){
             var_free(_returned);
             return rc;
@@ -498,7 +586,6 @@ int builtin_fncdef(void *_lisp, void *_node, size_t argnum, void *_returned) {
     Var fncname;
     Var params;
     Var *raw;
-    String name;
     if(argnum < 3) return TL_ERR_TOO_FEW_ARGS;
     for(i=2;i<argnum;i++){
         rc = call_get_arg_raw(node, i, &raw);
@@ -518,32 +605,38 @@ int builtin_fncdef(void *_lisp, void *_node, size_t argnum, void *_returned) {
         var_free(&params);
         return TL_ERR_INVALID_LIST_SIZE;
     }
+    if(fncname.type != TL_T_NAME || params.type != TL_T_NAME){
+        var_free(&fncname);
+        var_free(&params);
+        return TL_ERR_BAD_TYPE;
+    }
+    /* The function takes the parameters. */
     rc = var_user_func(&function, node, &params);
     if(rc){
         var_free(&fncname);
         var_free(&params);
         return rc;
     }
-    rc = var_raw_str(&name, VAR_STR_DATA(VAR_GET_ITEM(&fncname, 0)),
-                     VAR_STR_LEN(VAR_GET_ITEM(&fncname, 0)));
+    /* Find the slots of the parameters used in the body. */
+    for(i=2;i<argnum;i++){
+        call_resolve(((Node**)node->childs)[i],
+                     function.items->function.params);
+    }
+    rc = optimize_body(lisp, node);
     if(rc){
         var_free(&function);
         var_free(&fncname);
-        var_free(&params);
-        free(name.data);
         return rc;
     }
-    rc = tl_add_var(lisp, &function, &name);
+    rc = tl_move_var(lisp, &function,
+                     VAR_SYMBOL(VAR_GET_ITEM(&fncname, 0)));
     if(rc){
         var_free(&function);
         var_free(&fncname);
-        var_free(&params);
-        free(name.data);
         return rc;
     }
     /* TODO: Store calls. */
     var_free(&fncname);
-    var_free(&params);
     rc = var_num_from_float(_returned, 0);
     return rc;
 }
@@ -560,392 +653,502 @@ int builtin_if(void *_lisp, void *_node, size_t argnum, void *_returned) {
         var_free(&condition);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(condition.type != TL_T_NUM){
+    if(!VAR_IS_NUMBER(&condition)){
         var_free(&condition);
         return TL_ERR_BAD_TYPE;
     }
-    if(condition.items->num != 0){
-        rc = call_get_arg(_lisp, _node, 1, _returned, 1);
+    /* The branch that is evaluated is in tail position if the if is. */
+    if(VAR_IS_TRUE(&condition)){
+        rc = call_get_tail_arg(_lisp, _node, 1, _returned);
         var_free(&condition);
         return rc;
     }
-    rc = call_get_arg(_lisp, _node, 2, _returned, 1);
+    rc = call_get_tail_arg(_lisp, _node, 2, _returned);
     var_free(&condition);
     return rc;
 }
 
-int builtin_smaller(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+/* Gets the arguments of an operation on two numbers, that are single
+ * integers or floats, and do not have to be freed. */
+int builtin_get_nums(void *_lisp, void *_node, size_t argnum, Var *a,
+                     Var *b) {
     int rc;
-    TL_UNUSED(_lisp);
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
+    rc = call_get_arg(_lisp, _node, 0, a, 1);
+    if(rc) return rc;
+    rc = call_get_arg(_lisp, _node, 1, b, 1);
+    if(rc){
+        var_free(a);
+        return rc;
+    }
+    if(VAR_LEN(a) != 1 || VAR_LEN(b) != 1){
+        var_free(a);
+        var_free(b);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
+    if(!VAR_IS_NUMBER(a) || !VAR_IS_NUMBER(b)){
+        var_free(a);
+        var_free(b);
         return TL_ERR_BAD_TYPE;
     }
-    if(args[0].items->num < args[1].items->num){
-        rc = var_num_from_float(_returned, 1);
-        return rc;
+    return TL_SUCCESS;
+}
+
+int builtin_smaller(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    int rc;
+    Var a;
+    Var b;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        return var_int(_returned,
+                       VAR_ITEMS(&a)->integer < VAR_ITEMS(&b)->integer);
     }
-    rc = var_num_from_float(_returned, 0);
-    return rc;
+    return var_int(_returned, VAR_FLOAT(&a) < VAR_FLOAT(&b));
 }
 
 int builtin_bigger(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
-    }
-    if(args[0].items->num > args[1].items->num){
-        rc = var_num_from_float(_returned, 1);
-        return rc;
+    Var a;
+    Var b;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        return var_int(_returned,
+                       VAR_ITEMS(&a)->integer > VAR_ITEMS(&b)->integer);
     }
-    rc = var_num_from_float(_returned, 0);
-    return rc;
+    return var_int(_returned, VAR_FLOAT(&a) > VAR_FLOAT(&b));
 }
 
 int builtin_smaller_or_equal(void *_lisp, void *_node, size_t argnum,
                              void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
-    }
-    if(args[0].items->num <= args[1].items->num){
-        rc = var_num_from_float(_returned, 1);
-        return rc;
+    Var a;
+    Var b;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        return var_int(_returned,
+                       VAR_ITEMS(&a)->integer <= VAR_ITEMS(&b)->integer);
     }
-    rc = var_num_from_float(_returned, 0);
-    return rc;
+    return var_int(_returned, VAR_FLOAT(&a) <= VAR_FLOAT(&b));
 }
 
 int builtin_bigger_or_equal(void *_lisp, void *_node, size_t argnum,
                             void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
-    }
-    if(args[0].items->num >= args[1].items->num){
-        rc = var_num_from_float(_returned, 1);
-        return rc;
+    Var a;
+    Var b;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        return var_int(_returned,
+                       VAR_ITEMS(&a)->integer >= VAR_ITEMS(&b)->integer);
     }
-    rc = var_num_from_float(_returned, 0);
-    return rc;
+    return var_int(_returned, VAR_FLOAT(&a) >= VAR_FLOAT(&b));
 }
 
-int builtin_equal(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+/* Compares two single numbers or strings. */
+int builtin_compare(void *_lisp, void *_node, size_t argnum, char *equal) {
     int rc;
-    TL_UNUSED(_lisp);
+    Var a;
+    Var b;
+    *equal = 0;
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
+    rc = call_get_arg(_lisp, _node, 0, &a, 1);
+    if(rc) return rc;
+    rc = call_get_arg(_lisp, _node, 1, &b, 1);
+    if(rc){
+        var_free(&a);
+        return rc;
+    }
+    if(VAR_LEN(&a) != 1 || VAR_LEN(&b) != 1){
+        var_free(&a);
+        var_free(&b);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(args[0].type != args[1].type){
+    if(VAR_IS_NUMBER(&a) && VAR_IS_NUMBER(&b)){
+        if(a.type == TL_T_INT && b.type == TL_T_INT){
+            *equal = VAR_ITEMS(&a)->integer == VAR_ITEMS(&b)->integer;
+        }else{
+            *equal = VAR_FLOAT(&a) == VAR_FLOAT(&b);
+        }
+        return TL_SUCCESS;
+    }
+    if(a.type != TL_T_STR || b.type != TL_T_STR){
+        var_free(&a);
+        var_free(&b);
         return TL_ERR_BAD_TYPE;
     }
-    switch(args[0].type){
-        case TL_T_STR:
-            if(args[0].items->string.len == args[1].items->string.len){
-                if(!memcmp(args[0].items->string.data,
-                           args[1].items->string.data,
-                           args[0].items->string.len)){
-                    rc = var_num_from_float(_returned, 1);
-                    return rc;
-                }
-            }
-            rc = var_num_from_float(_returned, 0);
-            return rc;
-        case TL_T_NUM:
-            if(args[0].items->num == args[1].items->num){
-                rc = var_num_from_float(_returned, 1);
-                return rc;
-            }
-            rc = var_num_from_float(_returned, 0);
-            return rc;
-        default:
-            return TL_ERR_BAD_TYPE;
+    if(VAR_ITEMS(&a)->string.len == VAR_ITEMS(&b)->string.len){
+        *equal = !memcmp(VAR_ITEMS(&a)->string.data,
+                         VAR_ITEMS(&b)->string.data,
+                         VAR_ITEMS(&a)->string.len);
     }
+    var_free(&a);
+    var_free(&b);
     return TL_SUCCESS;
 }
 
+int builtin_equal(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    int rc;
+    char equal;
+    rc = builtin_compare(_lisp, _node, argnum, &equal);
+    if(rc) return rc;
+    return var_int(_returned, equal);
+}
+
 int builtin_not_equal(void *_lisp, void *_node, size_t argnum,
                       void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != args[1].type){
-        return TL_ERR_BAD_TYPE;
-    }
-    switch(args[0].type){
-        case TL_T_STR:
-            if(args[0].items->string.len == args[1].items->string.len){
-                if(!memcmp(args[0].items->string.data,
-                           args[1].items->string.data,
-                           args[0].items->string.len)){
-                    rc = var_num_from_float(_returned, 0);
-                    return rc;
-                }
-            }
-            rc = var_num_from_float(_returned, 1);
-            return rc;
-        case TL_T_NUM:
-            if(args[0].items->num == args[1].items->num){
-                rc = var_num_from_float(_returned, 0);
-                return rc;
-            }
-            rc = var_num_from_float(_returned, 1);
-            return rc;
-        default:
-            return TL_ERR_BAD_TYPE;
-    }
-    return TL_SUCCESS;
+    char equal;
+    rc = builtin_compare(_lisp, _node, argnum, &equal);
+    if(rc) return rc;
+    return var_int(_returned, !equal);
 }
 
+/* The operations on two integers give an integer, unless it does not
+ * fit. */
 int builtin_substract(void *_lisp, void *_node, size_t argnum,
                       void *_returned) {
-    LizyLang *lisp = _lisp;
-    Node *node = _node;
     int rc;
     Var a;
     Var b;
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    rc = call_get_arg(lisp, node, 0, &a, 1);
+    TL_INT x, y;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
     if(rc) return rc;
-    rc = call_get_arg(lisp, node, 1, &b, 1);
-    if(rc){
-        var_free(&a);
-        return rc;
-    }
-    if(VAR_LEN(&a) != 1 || VAR_LEN(&b) != 1){
-        var_free(&a);
-        var_free(&b);
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(a.type != TL_T_NUM || b.type != TL_T_NUM){
-        var_free(&a);
-        var_free(&b);
-        return TL_ERR_BAD_TYPE;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        x = VAR_ITEMS(&a)->integer;
+        y = VAR_ITEMS(&b)->integer;
+        if(y < 0 ? x <= TL_INT_MAX+y : x >= TL_INT_MIN+y){
+            return var_int(_returned, x-y);
+        }
     }
-    rc = var_num_from_float(_returned, a.items->num-b.items->num);
-    var_free(&a);
-    var_free(&b);
-    return rc;
+    return var_num_from_float(_returned, NUMBER_SUB(VAR_FLOAT(&a),
+                                                    VAR_FLOAT(&b)));
 }
 
 int builtin_multiply(void *_lisp, void *_node, size_t argnum,
                      void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
+    Var a;
+    Var b;
+    TL_INT x, y;
+    char fits;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        x = VAR_ITEMS(&a)->integer;
+        y = VAR_ITEMS(&b)->integer;
+        if(x > 0){
+            fits = y > 0 ? x <= TL_INT_MAX/y : y >= TL_INT_MIN/x;
+        }else{
+            fits = y > 0 ? x >= TL_INT_MIN/y : !x || y >= TL_INT_MAX/x;
+        }
+        if(fits) return var_int(_returned, x*y);
     }
-    rc = var_num_from_float(_returned, args[0].items->num*args[1].items->num);
-    return rc;
+    return var_num_from_float(_returned, NUMBER_MUL(VAR_FLOAT(&a),
+                                                    VAR_FLOAT(&b)));
 }
 
+/* The quotient of two integers is an integer if the division is exact. */
 int builtin_divide(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
-    }
-    if(args[1].items->num == 0){
-        return TL_ERR_DIVISION_BY_ZERO;
+    Var a;
+    Var b;
+    TL_INT x, y;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(VAR_FLOAT(&b) == 0) return TL_ERR_DIVISION_BY_ZERO;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        x = VAR_ITEMS(&a)->integer;
+        y = VAR_ITEMS(&b)->integer;
+        if((y != -1 || x != TL_INT_MIN) && x%y == 0){
+            return var_int(_returned, x/y);
+        }
     }
-    rc = var_num_from_float(_returned, args[0].items->num/args[1].items->num);
-    return rc;
+    return var_num_from_float(_returned, NUMBER_DIV(VAR_FLOAT(&a),
+                                                    VAR_FLOAT(&b)));
 }
 
 int builtin_modulo(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
     int rc;
-    TL_UNUSED(_lisp);
-    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
-    else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1 || VAR_LEN(args+1) != 1){
-        return TL_ERR_INVALID_LIST_SIZE;
-    }
-    if(args[0].type != TL_T_NUM || args[1].type != TL_T_NUM){
-        return TL_ERR_BAD_TYPE;
-    }
-    if(args[1].items->num == 0){
-        return TL_ERR_DIVISION_BY_ZERO;
+    Var a;
+    Var b;
+    rc = builtin_get_nums(_lisp, _node, argnum, &a, &b);
+    if(rc) return rc;
+    if(VAR_FLOAT(&b) == 0) return TL_ERR_DIVISION_BY_ZERO;
+    if(a.type == TL_T_INT && b.type == TL_T_INT){
+        return var_int(_returned, number_int_mod(VAR_ITEMS(&a)->integer,
+                                                 VAR_ITEMS(&b)->integer));
     }
-    rc = var_num_from_float(_returned, fmod(args[0].items->num,
-                                            args[1].items->num));
-    return rc;
+    return var_num_from_float(_returned, NUMBER_MOD(VAR_FLOAT(&a),
+                                                    VAR_FLOAT(&b)));
+}
+
+/* Rounded floats that fit are integers, so that they can be used as
+ * indices without converting them again. */
+int builtin_round(Var *returned, TL_FLOAT num) {
+    if(NUMBER_FITS_INT(num)) return var_int(returned, NUMBER_TO_INT(num));
+    return var_num_from_float(returned, num);
 }
 
 int builtin_floor(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    TL_UNUSED(_lisp);
+    Var a;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1){
+    rc = call_get_arg(lisp, node, 0, &a, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&a) != 1){
+        var_free(&a);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(args[0].type != TL_T_NUM){
+    if(a.type == TL_T_INT) return var_move(&a, _returned);
+    if(a.type != TL_T_NUM){
+        var_free(&a);
         return TL_ERR_BAD_TYPE;
     }
-    rc = var_num_from_float(_returned, floor(args[0].items->num));
-    return rc;
+    return builtin_round(_returned, NUMBER_FLOOR(VAR_ITEMS(&a)->num));
 }
 
 int builtin_ceil(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    TL_UNUSED(_lisp);
+    Var a;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1){
+    rc = call_get_arg(lisp, node, 0, &a, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&a) != 1){
+        var_free(&a);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(args[0].type != TL_T_NUM){
+    if(a.type == TL_T_INT) return var_move(&a, _returned);
+    if(a.type != TL_T_NUM){
+        var_free(&a);
         return TL_ERR_BAD_TYPE;
     }
-    rc = var_num_from_float(_returned, ceil(args[0].items->num));
-    return rc;
+    return builtin_round(_returned, NUMBER_CEIL(VAR_ITEMS(&a)->num));
 }
 
 int builtin_parsenum(void *_lisp, void *_node, size_t argnum,
                      void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    TL_UNUSED(_lisp);
+    Var str;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1){
+    rc = call_get_arg(lisp, node, 0, &str, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&str) != 1){
+        var_free(&str);
         return TL_ERR_INVALID_LIST_SIZE;
     }
-    if(args[0].type != TL_T_STR){
+    if(str.type != TL_T_STR){
+        var_free(&str);
         return TL_ERR_BAD_TYPE;
     }
-    if(!var_isnum(args[0].items->string.data, args[0].items->string.len)){
+    if(!var_isnum(VAR_ITEMS(&str)->string.data, VAR_ITEMS(&str)->string.len)){
+        var_free(&str);
         return TL_ERR_BAD_INPUT;
     }
-    rc = var_num(_returned, args[0].items->string.data,
-                 args[0].items->string.len);
+    rc = var_num(_returned, VAR_ITEMS(&str)->string.data,
+                 VAR_ITEMS(&str)->string.len);
+    var_free(&str);
     return rc;
 }
 
+int builtin_numstr(void *_lisp, void *_node, size_t argnum, void *_returned) {
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
+    int rc;
+    char num[NUMBER_STR_SZ];
+    size_t len;
+    Var a;
+    if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
+    else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
+    rc = call_get_arg(lisp, node, 0, &a, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&a) != 1){
+        var_free(&a);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    if(a.type == TL_T_INT){
+        len = number_int_str(num, VAR_ITEMS(&a)->integer);
+    }else if(a.type == TL_T_NUM){
+        len = number_str(num, VAR_ITEMS(&a)->num);
+    }else{
+        var_free(&a);
+        return TL_ERR_BAD_TYPE;
+    }
+    return var_str(_returned, num, len);
+}
+
 int builtin_callif(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    /* TODO: Rewrite it! */
-    return TL_SUCCESS;
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
+    Node call;
+    Var call_var;
+    Item call_item;
+    Var *name;
+    Var condition;
+    Function *function;
+    int rc;
+    if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
+    rc = call_get_arg(lisp, node, 0, &condition, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&condition) != 1){
+        var_free(&condition);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    if(!VAR_IS_NUMBER(&condition)){
+        var_free(&condition);
+        return TL_ERR_BAD_TYPE;
+    }
+    if(!VAR_IS_TRUE(&condition)){
+        /* Return 1 so that callif can end a recursion in a product. */
+        var_free(&condition);
+        return var_int(_returned, 1);
+    }
+    var_free(&condition);
+    rc = call_get_arg_raw(node, 1, &name);
+    if(rc) return rc;
+    if(name->type != TL_T_NAME) return TL_ERR_BAD_TYPE;
+    if(VAR_LEN(name) != 1) return TL_ERR_INVALID_LIST_SIZE;
+    /* The node of the name caches the function. */
+    rc = call_find(lisp, ((Node**)node->childs)[1], VAR_ITEMS(name)->symbol,
+                   &function);
+    if(rc) return rc;
+    /* Call the function with the remaining arguments, without copying
+     * them. In tail position, call_function only stores the call. */
+    call_item.call.function = VAR_ITEMS(name)->symbol;
+    call_item.call.has_func = 1;
+    call_var.type = TL_T_CALL;
+    call_var.items = &call_item;
+    call_var.size = 1;
+    call_var.null = 0;
+    node_init(&call, &call_var);
+    call.childs = (Node**)node->childs+2;
+    call.childnum = argnum-2;
+    call.parent = node->parent;
+    call.line = node->line;
+    return call_function(lisp, &call, function, _returned);
 }
 
 int builtin_len(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    TL_UNUSED(_lisp);
+    Var list;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    rc = var_num_from_float(_returned, VAR_LEN(args));
+    rc = call_get_arg(lisp, node, 0, &list, 1);
+    if(rc) return rc;
+    rc = var_int(_returned, VAR_LEN(&list));
+    var_free(&list);
     return rc;
 }
 
 int builtin_strlen(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    TL_UNUSED(_lisp);
+    Var str;
     if(argnum < 1) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 1) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    if(args->type != TL_T_STR) return TL_ERR_BAD_TYPE;
-    rc = var_num_from_float(_returned, args->items->string.len);
+    rc = call_get_arg(lisp, node, 0, &str, 1);
+    if(rc) return rc;
+    if(VAR_LEN(&str) != 1){
+        var_free(&str);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    if(str.type != TL_T_STR){
+        var_free(&str);
+        return TL_ERR_BAD_TYPE;
+    }
+    rc = var_int(_returned, VAR_ITEMS(&str)->string.len);
+    var_free(&str);
     return rc;
 }
 
 int builtin_get(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    int index;
-    TL_UNUSED(_lisp);
+    TL_INT index;
+    Var list;
+    Var pos;
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(args[1].type != TL_T_NUM) return TL_ERR_BAD_TYPE;
-    if(VAR_LEN(args+1) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    index = (int)args[1].items->num;
-    if(index < 0 || (size_t)index >= VAR_LEN(args)){
-        return TL_ERR_OUT_OF_RANGE;
+    rc = call_get_arg(lisp, node, 0, &list, 1);
+    if(rc) return rc;
+    rc = call_get_arg(lisp, node, 1, &pos, 1);
+    if(rc){
+        var_free(&list);
+        return rc;
     }
-    switch(args->type){
-        case TL_T_NAME:
-            rc = var_str(_returned, args->items[index].string.data,
-                         args->items[index].string.len);
-            if(!rc) ((Var*)_returned)->type = TL_T_NAME;
-            return rc;
-        case TL_T_STR:
-            rc = var_str(_returned, args->items[index].string.data,
-                         args->items[index].string.len);
-            return rc;
-        case TL_T_NUM:
-            rc = var_num_from_float(_returned, args->items[index].num);
-            return rc;
-        default:
-            return TL_ERR_BAD_TYPE;
+    if(!VAR_IS_NUMBER(&pos)){
+        var_free(&list);
+        var_free(&pos);
+        return TL_ERR_BAD_TYPE;
     }
-    return TL_SUCCESS;
+    if(VAR_LEN(&pos) != 1){
+        var_free(&list);
+        var_free(&pos);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    index = VAR_INDEX(&pos);
+    var_free(&pos);
+    if(index < 0 || (size_t)index >= VAR_LEN(&list)){
+        var_free(&list);
+        return TL_ERR_OUT_OF_RANGE;
+    }
+    /* The item shares the data of the list. */
+    rc = var_item(&list, index, _returned);
+    var_free(&list);
+    return rc;
 }
 
 int builtin_strget(void *_lisp, void *_node, size_t argnum, void *_returned) {
-    Var *args = NULL; /* TODO: Fix required! */
+    LizyLang *lisp = _lisp;
+    Node *node = _node;
     int rc;
-    int index;
-    TL_UNUSED(_lisp);
+    TL_INT index;
+    Var str;
+    Var pos;
     if(argnum < 2) return TL_ERR_TOO_FEW_ARGS;
     else if(argnum > 2) return TL_ERR_TOO_MANY_ARGS;
-    if(VAR_LEN(args) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    if(VAR_LEN(args+1) != 1) return TL_ERR_INVALID_LIST_SIZE;
-    if(args->type != TL_T_STR) return TL_ERR_BAD_TYPE;
-    if(args[1].type != TL_T_NUM) return TL_ERR_BAD_TYPE;
-    index = (int)args[1].items->num;
-    if(index < 0 || (size_t)index >= args->items->string.len){
+    rc = call_get_arg(lisp, node, 0, &str, 1);
+    if(rc) return rc;
+    rc = call_get_arg(lisp, node, 1, &pos, 1);
+    if(rc){
+        var_free(&str);
+        return rc;
+    }
+    if(VAR_LEN(&str) != 1 || VAR_LEN(&pos) != 1){
+        var_free(&str);
+        var_free(&pos);
+        return TL_ERR_INVALID_LIST_SIZE;
+    }
+    if(str.type != TL_T_STR || !VAR_IS_NUMBER(&pos)){
+        var_free(&str);
+        var_free(&pos);
+        return TL_ERR_BAD_TYPE;
+    }
+    index = VAR_INDEX(&pos);
+    var_free(&pos);
+    if(index < 0 || (size_t)index >= VAR_ITEMS(&str)->string.len){
+        var_free(&str);
         return TL_ERR_OUT_OF_RANGE;
     }
-    rc = var_str(_returned, args->items->string.data+index, sizeof(char));
+    rc = var_str(_returned, VAR_ITEMS(&str)->string.data+index, sizeof(char));
+    var_free(&str);
     return rc;
 }
@@ -51,10 +51,13 @@ int builtin_strdef(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_numdef(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_set(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_del(void *_lisp, void *_node, size_t argnum,  void *_returned);
+int builtin_write_item(LizyLang *lisp, Var *data, size_t i, char raw);
+int builtin_write(LizyLang *lisp, Var *data, char raw);
 int builtin_print(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_printraw(void *_lisp, void *_node, size_t argnum,
                      void *_returned);
 int builtin_input(void *_lisp, void *_node, size_t argnum, void *_returned);
+int builtin_lines(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_add(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_merge(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_params(void *_lisp, void *_node, size_t argnum, void *_returned);
@@ -62,12 +65,15 @@ int builtin_list(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_fncdef(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_defend(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_if(void *_lisp, void *_node, size_t argnum, void *_returned);
+int builtin_get_nums(void *_lisp, void *_node, size_t argnum, Var *a,
+                     Var *b);
 int builtin_smaller(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_bigger(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_smaller_or_equal(void *_lisp, void *_node, size_t argnum,
                              void *_returned);
 int builtin_bigger_or_equal(void *_lisp, void *_node, size_t argnum,
                             void *_returned);
+int builtin_compare(void *_lisp, void *_node, size_t argnum, char *equal);
 int builtin_equal(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_not_equal(void *_lisp, void *_node, size_t argnum,
                       void *_returned);
@@ -76,9 +82,11 @@ int builtin_substract(void *_lisp, void *_node, size_t argnum,
 int builtin_multiply(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_divide(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_modulo(void *_lisp, void *_node, size_t argnum, void *_returned);
+int builtin_round(Var *returned, TL_FLOAT num);
 int builtin_floor(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_ceil(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_parsenum(void *_lisp, void *_node, size_t argnum, void *_returned);
+int builtin_numstr(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_callif(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_len(void *_lisp, void *_node, size_t argnum, void *_returned);
 int builtin_strlen(void *_lisp, void *_node, size_t argnum, void *_returned);
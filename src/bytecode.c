@@ -0,0 +1,189 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file.
+ */
+
+#include <bytecode.h>
+
+int bc_grow(void **data, size_t *max, size_t need, size_t size) {
+    void *new;
+    size_t sz;
+    if(need <= *max) return TL_SUCCESS;
+    sz = *max ? *max : TL_BC_MIN_SZ;
+    while(sz < need) sz *= 2;
+    new = realloc(*data, sz*size);
+    if(!new) return TL_ERR_OUT_OF_MEM;
+    *data = new;
+    *max = sz;
+    return TL_SUCCESS;
+}
+
+int bc_init(Bytecode *bc) {
+    bc->code = NULL;
+    bc->len = 0;
+    bc->max = 0;
+    bc->consts = NULL;
+    bc->consts_num = 0;
+    bc->consts_max = 0;
+    bc->sites = NULL;
+    bc->sites_num = 0;
+    bc->sites_max = 0;
+    bc->thunks = NULL;
+    bc->thunks_num = 0;
+    bc->thunks_max = 0;
+    bc->lines = NULL;
+    bc->lines_num = 0;
+    bc->lines_max = 0;
+    return TL_SUCCESS;
+}
+
+int bc_emit(Bytecode *bc, unsigned char op, size_t arg) {
+    int rc;
+    rc = bc_grow((void**)&bc->code, &bc->max, bc->len+5, 1);
+    if(rc) return rc;
+    bc->code[bc->len++] = op;
+    if(!TL_OP_HAS_ARG(op)) return TL_SUCCESS;
+    if(arg > 0xFFFFFFFFUL) return TL_ERR_OUT_OF_RANGE;
+    bc->len += 4;
+    return bc_patch(bc, bc->len-4, arg);
+}
+
+int bc_patch(Bytecode *bc, size_t pos, size_t arg) {
+    bc->code[pos] = arg&0xFF;
+    bc->code[pos+1] = (arg>>8)&0xFF;
+    bc->code[pos+2] = (arg>>16)&0xFF;
+    bc->code[pos+3] = (arg>>24)&0xFF;
+    return TL_SUCCESS;
+}
+
+int bc_const(Bytecode *bc, Var *var, size_t *idx) {
+    int rc;
+    rc = bc_grow((void**)&bc->consts, &bc->consts_max, bc->consts_num+1,
+                 sizeof(Var));
+    if(rc) return rc;
+    rc = var_copy(var, bc->consts+bc->consts_num);
+    if(rc) return rc;
+    *idx = bc->consts_num++;
+    return TL_SUCCESS;
+}
+
+int bc_site(Bytecode *bc, size_t *idx) {
+    int rc;
+    rc = bc_grow((void**)&bc->sites, &bc->sites_max, bc->sites_num+1,
+                 sizeof(Site));
+    if(rc) return rc;
+    bc->sites[bc->sites_num].node = NULL;
+    bc->sites[bc->sites_num].callif = NULL;
+    bc->sites[bc->sites_num].symbol = 0;
+    bc->sites[bc->sites_num].childs = NULL;
+    bc->sites[bc->sites_num].childnum = 0;
+    bc->sites[bc->sites_num].function.builtin = 0;
+    bc->sites[bc->sites_num].thunks = 0;
+    bc->sites[bc->sites_num].fold_epoch = 0;
+    bc->sites[bc->sites_num].end = 0;
+    *idx = bc->sites_num++;
+    return TL_SUCCESS;
+}
+
+int bc_thunks(Bytecode *bc, size_t num, size_t *idx) {
+    int rc;
+    size_t i;
+    rc = bc_grow((void**)&bc->thunks, &bc->thunks_max, bc->thunks_num+num,
+                 sizeof(size_t));
+    if(rc) return rc;
+    for(i=0;i<num;i++) bc->thunks[bc->thunks_num+i] = TL_NO_CODE;
+    *idx = bc->thunks_num;
+    bc->thunks_num += num;
+    return TL_SUCCESS;
+}
+
+int bc_line(Bytecode *bc, size_t start, size_t end, size_t line) {
+    int rc;
+    rc = bc_grow((void**)&bc->lines, &bc->lines_max, bc->lines_num+1,
+                 sizeof(Line));
+    if(rc) return rc;
+    bc->lines[bc->lines_num].start = start;
+    bc->lines[bc->lines_num].end = end;
+    bc->lines[bc->lines_num].line = line;
+    bc->lines_num++;
+    return TL_SUCCESS;
+}
+
+int bc_find_line(Bytecode *bc, size_t pc, size_t *line) {
+    size_t i;
+    /* Only used when there is an error. */
+    for(i=0;i<bc->lines_num;i++){
+        if(pc >= bc->lines[i].start && pc < bc->lines[i].end){
+            *line = bc->lines[i].line;
+            return TL_SUCCESS;
+        }
+    }
+    return TL_ERR_NOT_DEF;
+}
+
+int bc_mark(Bytecode *bc, BytecodeMark *mark) {
+    mark->len = bc->len;
+    mark->consts_num = bc->consts_num;
+    mark->sites_num = bc->sites_num;
+    mark->thunks_num = bc->thunks_num;
+    mark->lines_num = bc->lines_num;
+    return TL_SUCCESS;
+}
+
+int bc_release(Bytecode *bc, BytecodeMark *mark) {
+    while(bc->consts_num > mark->consts_num){
+        var_free(bc->consts+--bc->consts_num);
+    }
+    bc->len = mark->len;
+    bc->sites_num = mark->sites_num;
+    bc->thunks_num = mark->thunks_num;
+    bc->lines_num = mark->lines_num;
+    return TL_SUCCESS;
+}
+
+int bc_free(Bytecode *bc) {
+    size_t i;
+    for(i=0;i<bc->consts_num;i++){
+        var_free(bc->consts+i);
+    }
+    free(bc->code);
+    free(bc->consts);
+    free(bc->sites);
+    free(bc->thunks);
+    free(bc->lines);
+    return bc_init(bc);
+}
@@ -0,0 +1,155 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file.
+ */
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <var.h>
+#include <tree.h>
+#include <defs.h>
+#include <platform.h>
+
+#define TL_BC_MIN_SZ 256
+
+/* Each opcode is a byte, followed by a 4 bytes little endian operand for
+ * the ones that have one. */
+enum {
+    TL_OP_CONST,     /* Push the constant arg. */
+    TL_OP_GLOBAL,    /* Push the value of the variable of symbol arg. */
+    TL_OP_PARAM,     /* Push the value of the parameter arg. */
+    TL_OP_EMPTY,     /* Push an argument that the builtin gets itself. */
+    TL_OP_POP,       /* Free the value on top of the stack. */
+    TL_OP_PARSE,     /* Replace the name on top of the stack by the value of
+                      * the variable. */
+    TL_OP_GUARD,     /* If the function of the site arg is not the one it was
+                      * compiled for, evaluate it with the tree walker and
+                      * jump to its end. */
+    TL_OP_BUILTIN,   /* Call the builtin of the site arg. */
+    TL_OP_CALL,      /* Call the user defined function of the site arg. */
+    TL_OP_TAILCALL,  /* Same as TL_OP_CALL, in the frame of the caller. */
+    TL_OP_EVAL,      /* Evaluate the node of the site arg with the tree
+                      * walker. */
+    TL_OP_JUMP,      /* Jump to arg. */
+    TL_OP_JUMPIFNOT, /* Pop a condition, and jump to arg if it is 0. */
+    TL_OP_RETURN,    /* Return the value on top of the stack. */
+    TL_OP_FOLDED     /* If the value folded for the site arg changed,
+                      * evaluate its node with the tree walker and jump to
+                      * its end. */
+};
+
+#define TL_OP_HAS_ARG(op) ((op) != TL_OP_EMPTY && (op) != TL_OP_POP && \
+                           (op) != TL_OP_PARSE && (op) != TL_OP_RETURN)
+
+#define TL_BC_ARG(code, pc) ((size_t)(code)[pc] | \
+                             (size_t)(code)[(pc)+1]<<8 | \
+                             (size_t)(code)[(pc)+2]<<16 | \
+                             (size_t)(code)[(pc)+3]<<24)
+
+/* Code of a function that can not be compiled. */
+#define TL_BAD_CODE ((size_t)-2)
+
+typedef struct {
+    /* Node of the call, or of the name of the function for callif. */
+    Node *node;
+    /* The callif node if the call is made by callif. */
+    Node *callif;
+    size_t symbol;
+    Node **childs;
+    size_t childnum;
+    /* Copy of the builtin it was compiled for, that is not a builtin for
+     * user defined functions. A copy is kept because the variable of the
+     * builtin may be deleted, and its memory reused by another function. */
+    Function function;
+    /* Index of the code of the first argument in thunks, for user defined
+     * functions. */
+    size_t thunks;
+    /* Fold epoch of the value that was folded, for TL_OP_FOLDED. */
+    size_t fold_epoch;
+    /* Code after the call. */
+    size_t end;
+} Site;
+
+/* Code of the statement of a user function that is on line. */
+typedef struct {
+    size_t start;
+    size_t end;
+    size_t line;
+} Line;
+
+typedef struct {
+    unsigned char *code;
+    size_t len;
+    size_t max;
+    Var *consts;
+    size_t consts_num;
+    size_t consts_max;
+    Site *sites;
+    size_t sites_num;
+    size_t sites_max;
+    size_t *thunks;
+    size_t thunks_num;
+    size_t thunks_max;
+    Line *lines;
+    size_t lines_num;
+    size_t lines_max;
+} Bytecode;
+
+/* Sizes of the bytecode, to remove what was added after. */
+typedef struct {
+    size_t len;
+    size_t consts_num;
+    size_t sites_num;
+    size_t thunks_num;
+    size_t lines_num;
+} BytecodeMark;
+
+int bc_grow(void **data, size_t *max, size_t need, size_t size);
+int bc_init(Bytecode *bc);
+int bc_emit(Bytecode *bc, unsigned char op, size_t arg);
+int bc_patch(Bytecode *bc, size_t pos, size_t arg);
+int bc_const(Bytecode *bc, Var *var, size_t *idx);
+int bc_site(Bytecode *bc, size_t *idx);
+int bc_thunks(Bytecode *bc, size_t num, size_t *idx);
+int bc_line(Bytecode *bc, size_t start, size_t end, size_t line);
+int bc_find_line(Bytecode *bc, size_t pc, size_t *line);
+int bc_mark(Bytecode *bc, BytecodeMark *mark);
+int bc_release(Bytecode *bc, BytecodeMark *mark);
+int bc_free(Bytecode *bc);
+
+#endif
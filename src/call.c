@@ -45,224 +45,736 @@
  * 2024/10/19: Adding builtin function calling back.
  * 2024/10/20: Adding user defined function calling.
  * 2024/10/21: Getting arguments when calling user defined functions.
+ * 2026/10/18: Find the variables in the hash table. Only look for the
+ *             parameters of the callers when getting arguments, and evaluate
+ *             them in the context of the caller. Compare the symbols of the
+ *             names. Cache the function called by each node. Find the
+ *             parameters with the slots computed by call_resolve. Evaluate
+ *             each argument only once, and store it in the stack. Reuse
+ *             the frame for calls in tail position. Growable stack, with
+ *             the arguments of the frames stored together. Evaluate without
+ *             recursion, with a stack of continuations. Evaluate what a
+ *             builtin returns for the virtual machine. Parse the values in
+ *             place instead of copying them. Use the values folded by
+ *             the optimizer. Find the parameters without recursion.
+ *             The arguments of tail calls that use the parameters are
+ *             not evaluated before the call, their frames are kept.
+ *             Remove the frames when there is an error.
  */
 
 #include <call.h>
+#include <optimize.h>
 
 #define TL_MIN(a, b) ((a) < (b) ? (a) : (b))
 
+int call_find(LizyLang *lisp, Node *node, size_t symbol,
+              Function **function) {
+    Var *var;
+    int rc;
+    /* The cached function is valid as long as no function was defined,
+     * changed or deleted since it was stored. */
+    if(node->cache && node->epoch == lisp->epoch){
+        lisp->cache_hits++;
+        *function = node->cache;
+        return TL_SUCCESS;
+    }
+    lisp->cache_misses++;
+    rc = tl_get_var(lisp, symbol, &var);
+    if(rc || var->type != TL_T_FUNC){
+        return TL_ERR_FUNC_NOT_DEF;
+    }
+    *function = &var->items->function;
+    node->cache = *function;
+    node->epoch = lisp->epoch;
+    return TL_SUCCESS;
+}
+
 int call_exec(LizyLang *lisp, Node *node, Var *returned) {
+    if(node->var->type != TL_T_CALL){
+        return TL_ERR_VALUE_OUTSIDE_OF_CALL;
+    }
+    return call_eval(lisp, node, returned);
+}
+
+int call_eval(LizyLang *lisp, Node *node, Var *returned) {
+    Cont *cont;
+    size_t root;
+    int rc;
+    char done;
+    root = lisp->conts_cur;
+    rc = call_cont(lisp, TL_K_ROOT, lisp->context, &cont);
+    if(rc) return rc;
+    rc = call_enter(lisp, node, 0, returned, &done);
+    if(rc){
+        call_unwind(lisp, root);
+        return rc;
+    }
+    if(done){
+        lisp->conts_cur = root;
+        return TL_SUCCESS;
+    }
+    return call_run(lisp, root, returned);
+}
+
+int call_function(LizyLang *lisp, Node *node, Function *function,
+                  Var *returned) {
+    if(function->builtin){
+        /* Call the right builtin function. */
+        return function->ptr.f(lisp, node, node->childnum, returned);
+    }
+    /* The evaluator calls it once the builtin that called it returned. */
+    lisp->tail_call = *node;
+    lisp->tail_function = function;
+    return TL_SUCCESS;
+}
+
+int call_eval_pending(LizyLang *lisp, Var *returned) {
     Function *function;
-    char found;
+    Cont *cont;
+    Node *node;
+    size_t root;
+    int rc;
+    /* Evaluate what a builtin that was called outside of the evaluator
+     * returns in its place. */
+    if(lisp->next){
+        node = lisp->next;
+        lisp->next = NULL;
+        return call_eval(lisp, node, returned);
+    }
+    function = lisp->tail_function;
+    lisp->tail_function = NULL;
+    root = lisp->conts_cur;
+    rc = call_cont(lisp, TL_K_ROOT, lisp->context, &cont);
+    if(rc) return rc;
+    rc = call_user(lisp, &lisp->tail_call, function, 0);
+    if(rc){
+        call_unwind(lisp, root);
+        return rc;
+    }
+    return call_run(lisp, root, returned);
+}
+
+int call_reserve(LizyLang *lisp, size_t n) {
+    Arg *args;
+    size_t max;
+    if(lisp->args_cur+n <= lisp->args_max) return TL_SUCCESS;
+    max = lisp->args_max ? lisp->args_max : TL_ARGS_MIN;
+    while(max < lisp->args_cur+n) max *= 2;
+    args = realloc(lisp->args, max*sizeof(Arg));
+    if(!args) return TL_ERR_OUT_OF_MEM;
+    lisp->args = args;
+    lisp->args_max = max;
+    return TL_SUCCESS;
+}
+
+int call_push(LizyLang *lisp, Node **childs, size_t childnum,
+              Function *function) {
+    Frame *frame;
+    Arg *arg;
+    size_t i, n, max;
+    int rc;
+    n = VAR_LEN((Var*)function->params);
+    if(childnum < n) return TL_ERR_TOO_FEW_ARGS;
+    if(childnum > n) return TL_ERR_TOO_MANY_ARGS;
+    if(lisp->stack_cur >= lisp->max_depth) return TL_ERR_STACK_OVERFLOW;
+    if(lisp->stack_cur >= lisp->stack_max){
+        max = lisp->stack_max ? lisp->stack_max*2 : TL_STACK_MIN;
+        frame = realloc(lisp->stack, max*sizeof(Frame));
+        if(!frame) return TL_ERR_OUT_OF_MEM;
+        lisp->stack = frame;
+        lisp->stack_max = max;
+    }
+    rc = call_reserve(lisp, n);
+    if(rc) return rc;
+    frame = lisp->stack+lisp->stack_cur;
+    frame->function = function;
+    frame->args = lisp->args_cur;
+    frame->argnum = n;
+    frame->context = lisp->context;
+    frame->envs = 0;
+    frame->kept = 0;
+    /* The arguments are evaluated and stored when they are used for the
+     * first time. */
+    for(i=0;i<n;i++){
+        arg = lisp->args+lisp->args_cur+i;
+        arg->node = childs[i];
+        arg->context = lisp->context;
+        arg->evaluated = 0;
+        arg->code = TL_NO_CODE;
+    }
+    lisp->args_cur += n;
+#if TL_DEBUG_STACK
+    printf("Added to stack at %ld!\n", lisp->stack_cur);
+#endif
+    lisp->stack_cur++;
+    lisp->context = lisp->stack_cur;
+    return TL_SUCCESS;
+}
+
+void call_pop(LizyLang *lisp) {
+    Frame *frame;
     size_t i;
+    /* The frames kept for the arguments of tail calls are removed with it. */
+    frame = lisp->stack+lisp->stack_cur-1;
+    lisp->context = frame->context;
+    lisp->stack_cur -= frame->envs+1;
+    frame = lisp->stack+lisp->stack_cur;
+    for(i=frame->args;i<lisp->args_cur;i++){
+        if(lisp->args[i].evaluated) var_free(&lisp->args[i].value);
+    }
+    lisp->args_cur = frame->args;
+#if TL_DEBUG_STACK
+    printf("Removed %ld from stack!\n", lisp->stack_cur);
+#endif
+}
+
+int call_cont(LizyLang *lisp, unsigned char type, size_t context,
+              Cont **cont) {
+    Cont *conts;
+    size_t max;
+    if(lisp->conts_cur >= lisp->conts_max){
+        max = lisp->conts_max ? lisp->conts_max*2 : TL_CONTS_MIN;
+        conts = realloc(lisp->conts, max*sizeof(Cont));
+        if(!conts) return TL_ERR_OUT_OF_MEM;
+        lisp->conts = conts;
+        lisp->conts_max = max;
+    }
+    *cont = lisp->conts+lisp->conts_cur++;
+    (*cont)->type = type;
+    (*cont)->tail = 0;
+    (*cont)->context = context;
+    (*cont)->i = 0;
+    return TL_SUCCESS;
+}
+
+int call_value(LizyLang *lisp, Var *value) {
+    Var *values;
+    size_t max;
+    if(lisp->values_cur >= lisp->values_max){
+        max = lisp->values_max ? lisp->values_max*2 : TL_VALUES_MIN;
+        values = realloc(lisp->values, max*sizeof(Var));
+        if(!values) return TL_ERR_OUT_OF_MEM;
+        lisp->values = values;
+        lisp->values_max = max;
+    }
+    lisp->values[lisp->values_cur++] = *value;
+    return TL_SUCCESS;
+}
+
+int call_preeval(Function *function, size_t idx, Node *arg) {
+    if(arg->var->type != TL_T_CALL && !arg->is_param) return 0;
+    switch(function->eval){
+        case TL_ARGS_EVAL:
+            return 1;
+        case TL_ARGS_CALLS:
+            return arg->var->type == TL_T_CALL;
+        case TL_ARGS_NAME:
+            return idx > 0;
+        case TL_ARGS_FIRST:
+            return idx == 0;
+        default:
+            return 0;
+    }
+}
+
+int call_user(LizyLang *lisp, Node *node, Function *function, char tail) {
+    Cont *cont;
+    int rc;
+    if(!tail){
+        rc = call_push(lisp, (Node**)node->childs, node->childnum,
+                       function);
+        if(rc) return rc;
+        rc = call_cont(lisp, TL_K_BODY, lisp->context, &cont);
+        if(rc){
+            call_pop(lisp);
+            return rc;
+        }
+        cont->node = function->ptr.fncdef;
+        cont->i = 2;
+        return TL_SUCCESS;
+    }
+    /* Tail call: the frame of the function that is running is reused. */
+    rc = call_rebind(lisp, (Node**)node->childs, node->childnum, function,
+                     NULL);
+    if(rc) return rc;
+    /* Run the new body in the body of the frame. */
+    cont = lisp->conts+lisp->conts_cur-1;
+    cont->node = function->ptr.fncdef;
+    cont->i = 2;
+    return TL_SUCCESS;
+}
+
+int call_enter(LizyLang *lisp, Node *node, char tail, Var *value,
+               char *done) {
+    Function *function;
+    Cont *cont;
+    size_t arg;
     int rc;
-    size_t line;
-    Var call_return;
+    *done = 0;
+    if(node->is_param){
+        if(!lisp->context) return TL_ERR_INTERNAL;
+        arg = lisp->stack[lisp->context-1].args+node->slot;
+        if(lisp->args[arg].evaluated){
+            *done = 1;
+            return var_copy(&lisp->args[arg].value, value);
+        }
+        /* Evaluate the argument in the context of the caller, only once. */
+        rc = call_cont(lisp, TL_K_FORCE, lisp->args[arg].context, &cont);
+        if(rc) return rc;
+        cont->base = arg;
+        return TL_SUCCESS;
+    }
+    if(OPTIMIZE_FOLDED(lisp, node)){
+        *done = 1;
+        return var_copy(node->folded, value);
+    }
     if(node->var->type != TL_T_CALL){
-        return TL_ERR_VALUE_OUTSIDE_OF_CALL;
+        rc = call_parse_arg(lisp, node->var, value, lisp->context);
+        if(rc) return rc;
+        *done = 1;
+        return TL_SUCCESS;
     }
     if(node->var->size != 1){
         return TL_ERR_INVALID_LIST_SIZE;
     }
+    if(!node->var->items->call.has_func){
+        return TL_ERR_NOFUNC;
+    }
 #if TL_DEBUG_CALL
     fputs("Calling \"", stdout);
-    fwrite(node->var->items->call.function.data, 1,
-           node->var->items->call.function.len, stdout);
+    fwrite(symbol_name(&lisp->symbols, node->var->items->call.function)->data,
+           1, symbol_name(&lisp->symbols,
+                          node->var->items->call.function)->len, stdout);
     puts("\"");
 #endif
-    /* Find the function */
-    found = 0;
-    for(i=0;i<lisp->var_num;i++){
-        if(lisp->vars[i].type == TL_T_FUNC){
-#if TL_DEBUG_VARS
-            fputc('"', stdout);
-            fwrite(lisp->var_names[i].data, 1,
-                   lisp->var_names[i].len, stdout);
-            fputs("\", \"", stdout);
-            fwrite(node->var->items->call.function.data, 1,
-                   node->var->items->call.function.len, stdout);
-            fputs("\"\n", stdout);
-#endif
-            if(lisp->var_names[i].len != node->var->items->call.function.len){
-                continue;
-            }
-            if(!memcmp(lisp->var_names[i].data,
-                       node->var->items->call.function.data,
-                       lisp->var_names[i].len)){
-                function = &lisp->vars[i].items->function;
-                found = 1;
+    rc = call_find(lisp, node, node->var->items->call.function, &function);
+    if(rc) return rc;
+    if(!function->builtin) return call_user(lisp, node, function, tail);
+    rc = call_cont(lisp, TL_K_BUILTIN, lisp->context, &cont);
+    if(rc) return rc;
+    cont->tail = tail;
+    cont->node = node;
+    cont->function = function;
+    cont->base = lisp->values_cur;
+    return TL_SUCCESS;
+}
+
+int call_builtin(LizyLang *lisp, Var *value, char *done) {
+    Cont *cont;
+    Node *node;
+    Node *arg;
+    Function *function;
+    Function *old_function;
+    Node *old_node;
+    size_t old_base;
+    size_t i;
+    int rc;
+    char tail;
+    Var empty;
+    cont = lisp->conts+lisp->conts_cur-1;
+    node = cont->node;
+    /* Evaluate the arguments that are needed before calling it. */
+    while(cont->i < node->childnum){
+        arg = ((Node**)node->childs)[cont->i];
+        cont->i++;
+        if(!call_preeval(cont->function, cont->i-1, arg)){
+            empty.type = arg->var->type;
+            empty.items = NULL;
+            empty.size = 0;
+            empty.null = 0;
+            rc = call_value(lisp, &empty);
+            if(rc) return rc;
+            continue;
+        }
+        rc = call_enter(lisp, arg, 0, value, done);
+        if(rc) return rc;
+        if(!*done) return TL_SUCCESS;
+        rc = call_value(lisp, value);
+        if(rc){
+            var_free(value);
+            return rc;
+        }
+        cont = lisp->conts+lisp->conts_cur-1;
+    }
+    function = cont->function;
+    tail = cont->tail;
+    old_function = lisp->eval_function;
+    old_node = lisp->eval_node;
+    old_base = lisp->eval_base;
+    lisp->eval_function = function;
+    lisp->eval_node = node;
+    lisp->eval_base = cont->base;
+    lisp->next = NULL;
+    lisp->tail_function = NULL;
+    rc = function->ptr.f(lisp, node, node->childnum, value);
+    lisp->eval_function = old_function;
+    lisp->eval_node = old_node;
+    lisp->eval_base = old_base;
+    cont = lisp->conts+lisp->conts_cur-1;
+    for(i=cont->base;i<lisp->values_cur;i++){
+        var_free(lisp->values+i);
+    }
+    lisp->values_cur = cont->base;
+    lisp->conts_cur--;
+    *done = 0;
+    if(rc) return rc;
+    if(lisp->next){
+        /* The builtin returns the value of this node, that is evaluated in
+         * its tail position. */
+        arg = lisp->next;
+        lisp->next = NULL;
+        return call_enter(lisp, arg, tail, value, done);
+    }
+    if(lisp->tail_function){
+        function = lisp->tail_function;
+        lisp->tail_function = NULL;
+        return call_user(lisp, &lisp->tail_call, function, tail);
+    }
+    *done = 1;
+    return TL_SUCCESS;
+}
+
+/* Marks the frame of the tail call chain from low to top that arg uses, if it
+ * is not evaluated yet. */
+void call_keep(LizyLang *lisp, Arg *arg, size_t low, size_t top) {
+    if(arg->evaluated || arg->context <= low || arg->context > top+1) return;
+    lisp->stack[arg->context-1].kept = 1;
+}
+
+/* Changes the context of arg to the one of the frame it uses once the frames
+ * from low to top are moved. */
+void call_move_context(LizyLang *lisp, Arg *arg, size_t low, size_t top) {
+    if(arg->context <= low || arg->context > top+1) return;
+    if(!lisp->stack[arg->context-1].kept) return;
+    arg->context = lisp->stack[arg->context-1].kept;
+}
+
+/* Frees the arguments from base that are not in a frame. */
+void call_drop(LizyLang *lisp, size_t base) {
+    size_t i;
+    for(i=base;i<lisp->args_cur;i++){
+        if(lisp->args[i].evaluated) var_free(&lisp->args[i].value);
+    }
+    lisp->args_cur = base;
+}
+
+int call_rebind(LizyLang *lisp, Node **childs, size_t childnum,
+                Function *function, size_t *codes) {
+    Frame *frame;
+    Arg *arg;
+    Arg *old;
+    size_t i, j, n, top, low, base, kept, args, context;
+    int rc;
+    n = VAR_LEN((Var*)function->params);
+    if(childnum < n) return TL_ERR_TOO_FEW_ARGS;
+    if(childnum > n) return TL_ERR_TOO_MANY_ARGS;
+    if(!lisp->context || lisp->context != lisp->stack_cur){
+        return TL_ERR_INTERNAL;
+    }
+    rc = call_reserve(lisp, n);
+    if(rc) return rc;
+    top = lisp->context-1;
+    frame = lisp->stack+top;
+    low = top-frame->envs;
+    context = frame->context;
+    /* The new arguments are stored after the ones of the frames, and are
+     * still evaluated only when they are used. */
+    base = lisp->args_cur;
+    for(i=0;i<n;i++) lisp->args[base+i].evaluated = 0;
+    lisp->args_cur += n;
+    for(i=0;i<n;i++){
+        arg = lisp->args+base+i;
+        arg->node = childs[i];
+        arg->code = codes ? codes[i] : TL_NO_CODE;
+        if(childs[i]->is_param){
+            /* Forward the parameter without evaluating it. */
+            old = lisp->args+frame->args+childs[i]->slot;
+            arg->node = old->node;
+            arg->context = old->context;
+            arg->code = old->code;
+            if(old->evaluated){
+                rc = var_copy(&old->value, &arg->value);
+                if(rc){
+                    call_drop(lisp, base);
+                    return rc;
+                }
+                arg->evaluated = 1;
             }
+        }else if(childs[i]->has_params){
+            /* It uses the parameters of this frame, that is then kept. */
+            arg->context = lisp->context;
+        }else{
+            arg->context = context;
         }
     }
-    if(!found){
-        return TL_ERR_FUNC_NOT_DEF;
+    /* The frames replaced by tail calls are only kept while an argument
+     * that is not evaluated yet uses their parameters. Arguments only use
+     * the frames below theirs. */
+    for(j=low;j<=top;j++) lisp->stack[j].kept = 0;
+    for(i=0;i<n;i++) call_keep(lisp, lisp->args+base+i, low, top);
+    for(j=top+1;j-- > low;){
+        if(!lisp->stack[j].kept) continue;
+        for(i=0;i<lisp->stack[j].argnum;i++){
+            call_keep(lisp, lisp->args+lisp->stack[j].args+i, low, top);
+        }
     }
-    if(function->builtin){
-        /* Call the right builtin function. */
-        rc = function->ptr.f(lisp, node, node->childnum, returned);
-        if(rc) return rc;
-    }else{
-        if(node->childnum < VAR_LEN((Var*)function->params)){
-            return TL_ERR_TOO_FEW_ARGS;
+    kept = low;
+    for(j=low;j<=top;j++){
+        if(lisp->stack[j].kept) lisp->stack[j].kept = ++kept;
+    }
+    if(kept >= lisp->max_depth){
+        call_drop(lisp, base);
+        return TL_ERR_STACK_OVERFLOW;
+    }
+    if(kept >= lisp->stack_max){
+        frame = realloc(lisp->stack, lisp->stack_max*2*sizeof(Frame));
+        if(!frame){
+            call_drop(lisp, base);
+            return TL_ERR_OUT_OF_MEM;
         }
-        if(node->childnum > VAR_LEN((Var*)function->params)){
-            return TL_ERR_TOO_MANY_ARGS;
+        lisp->stack = frame;
+        lisp->stack_max *= 2;
+    }
+    /* Remove the frames that are not used anymore, once all the contexts
+     * are changed. */
+    for(i=0;i<n;i++) call_move_context(lisp, lisp->args+base+i, low, top);
+    for(j=low;j<=top;j++){
+        frame = lisp->stack+j;
+        if(!frame->kept) continue;
+        for(i=0;i<frame->argnum;i++){
+            call_move_context(lisp, lisp->args+frame->args+i, low, top);
         }
-        lisp->stack[lisp->stack_cur].call = node;
-        lisp->stack[lisp->stack_cur].function = function;
-        lisp->stack[lisp->stack_cur].args =
-                malloc(((Node*)function->ptr.fncdef)->childnum*sizeof(Var));
-        lisp->stack[lisp->stack_cur].evaluated =
-                malloc(((Node*)function->ptr.fncdef)->childnum*sizeof(char));
-        memset(lisp->stack[lisp->stack_cur].evaluated, 0,
-               ((Node*)function->ptr.fncdef)->childnum*sizeof(char));
-#if TL_DEBUG_STACK
-        printf("Added to stack at %ld!\n", lisp->stack_cur);
-#endif
-        lisp->stack_cur++;
-        lisp->context++;
-        if(lisp->stack_cur >= TL_STACK_SZ) return TL_ERR_STACK_OVERFLOW;
-        line = lisp->line;
-        for(i=2;i<((Node*)function->ptr.fncdef)->childnum;i++){
-            rc = call_exec(lisp,
-                           ((Node**)((Node*)function->ptr.fncdef)->childs)[i],
-                           &call_return);
-            if(rc){
-                lisp->line =
-                    ((Node**)((Node*)function->ptr.fncdef)->childs)[i]->line;
-                lisp->context--;
-                return rc;
-            }
-            if(i < ((Node*)function->ptr.fncdef)->childnum-1){
-                var_free(&call_return);
+    }
+    args = lisp->stack[low].args;
+    for(j=low;j<=top;j++){
+        frame = lisp->stack+j;
+        if(!frame->kept){
+            for(i=0;i<frame->argnum;i++){
+                arg = lisp->args+frame->args+i;
+                if(arg->evaluated) var_free(&arg->value);
             }
+            continue;
         }
-        *returned = call_return;
-        lisp->line = line;
-        lisp->stack_cur--;
-        lisp->context--;
-        if(((Node*)lisp->stack[lisp->stack_cur].function->ptr.fncdef)
-           ->childnum){
-            if(lisp->stack[lisp->stack_cur].evaluated){
-                for(i=0;i<((Node**)((Node*)lisp->stack[lisp->stack_cur]
-                           .function->ptr.fncdef)->childs)[1]->childnum;i++){
-                    if(lisp->stack[lisp->stack_cur].evaluated[i]){
-                        var_free(lisp->stack[lisp->stack_cur].args+i);
-                    }
-                }
-            }
-            free(lisp->stack[lisp->stack_cur].args);
-            lisp->stack[lisp->stack_cur].args = NULL;
-            free(lisp->stack[lisp->stack_cur].evaluated);
-            lisp->stack[lisp->stack_cur].evaluated = NULL;
-#if TL_DEBUG_STACK
-            printf("Removed %ld from stack!\n", lisp->stack_cur);
-#endif
+        if(frame->argnum){
+            memmove(lisp->args+args, lisp->args+frame->args,
+                    frame->argnum*sizeof(Arg));
         }
+        frame->args = args;
+        args += frame->argnum;
+        lisp->stack[frame->kept-1] = *frame;
     }
+    if(n) memmove(lisp->args+args, lisp->args+base, n*sizeof(Arg));
+    lisp->args_cur = args+n;
+    frame = lisp->stack+kept;
+    frame->function = function;
+    frame->args = args;
+    frame->argnum = n;
+    frame->context = context;
+    frame->envs = kept-low;
+    lisp->stack_cur = kept+1;
+    lisp->context = lisp->stack_cur;
+    /* The body of the new function runs in place of the old one. */
+    lisp->conts[lisp->conts_cur-1].context = lisp->context;
     return TL_SUCCESS;
 }
 
-int call_get_arg(LizyLang *lisp, Node *node, size_t idx, Var *dest,
-                 char parse) {
-    Var parsed;
-    Var *src;
-    Var returned;
+int call_run(LizyLang *lisp, size_t root, Var *returned) {
+    Cont *cont;
+    Node *node;
+    Var value;
+    size_t c;
     int rc;
-    size_t context, n, old_ctx;
-    Function *function;
-    char free_returned = 0;
-    old_ctx = lisp->context;
-#if TL_DEBUG_CONTEXT
-    printf("Context: %ld\n", lisp->context);
-#endif
-    if(idx >= node->childnum) return TL_ERR_TOO_FEW_ARGS;
-    src = ((Node**)node->childs)[idx]->var;
-    context = lisp->context;
-    if(src->type == TL_T_NAME && parse && context){
-        while(context > 0){
-            context--;
-#if TL_DEBUG_STACK
-            printf("Reading stack item %ld!\n", context);
-#endif
-            function = lisp->stack[context].function;
-            if(function->builtin) return TL_ERR_INTERNAL;
-            for(n=0;n<VAR_LEN((Var*)function->params);n++){
-                /*
-                fwrite(((Var*)function->params)->items[n].string.data, 1,
-                    ((Var*)function->params)->items[n].string.len, stdout);
-                */
-                if(src->items->string.len ==
-                ((Var*)function->params)->items[n].string.len){
-                    if(!memcmp(src->items->string.data,
-                    ((Var*)function->params)->items[n].string.data,
-                    src->items->string.len)){
-                        src = ((Node**)((Node*)lisp->stack
-                                    [context].call)->childs)[n]->var;
-                        if(((Node**)((Node*)lisp->stack[context].call)
-                            ->childs)[n]->var->type == TL_T_CALL){
-                            lisp->context = context;
-#if TL_DEBUG_CONTEXT
-                            printf("Context when getting argument: %ld\n",
-                                   lisp->context);
-#endif
-                            rc = call_exec(lisp, ((Node**)((Node*)lisp->stack
-                                    [context].call)->childs)[n], &returned);
-                            if(rc){
-                                lisp->context = old_ctx;
-                                return rc;
-                            }
-                            src = &returned;
-                            free_returned = 1;
-                        }
+    char done = 0;
+    for(;;){
+        c = lisp->conts_cur-1;
+        cont = lisp->conts+c;
+        rc = TL_SUCCESS;
+        if(done){
+            /* Give the value to the continuation. */
+            switch(cont->type){
+                case TL_K_ROOT:
+                    lisp->context = cont->context;
+                    lisp->conts_cur = root;
+                    *returned = value;
+                    return TL_SUCCESS;
+                case TL_K_BUILTIN:
+                    rc = call_value(lisp, &value);
+                    if(rc) var_free(&value);
+                    done = 0;
+                    break;
+                case TL_K_BODY:
+                    if(cont->i < ((Node*)cont->node)->childnum){
+                        var_free(&value);
+                        done = 0;
+                    }else{
+                        /* The last value is returned by the function. */
+                        call_pop(lisp);
+                        lisp->conts_cur--;
+                    }
+                    break;
+                case TL_K_FORCE:
+                    lisp->args[cont->base].value = value;
+                    lisp->args[cont->base].evaluated = 1;
+                    lisp->conts_cur--;
+                    rc = var_copy(&lisp->args[cont->base].value, &value);
+                    if(rc) done = 0;
+                    break;
+                default:
+                    rc = TL_ERR_INTERNAL;
+            }
+        }else{
+            lisp->context = cont->context;
+            switch(cont->type){
+                case TL_K_BUILTIN:
+                    rc = call_builtin(lisp, &value, &done);
+                    break;
+                case TL_K_BODY:
+                    node = ((Node**)cont->node->childs)[cont->i];
+                    cont->i++;
+                    /* The statements that were folded only matter for
+                     * their value, so only the last one is used. */
+                    if(cont->i < cont->node->childnum &&
+                       OPTIMIZE_FOLDED(lisp, node)) break;
+                    if(node->var->type != TL_T_CALL){
+                        rc = TL_ERR_VALUE_OUTSIDE_OF_CALL;
                         break;
                     }
-                }
+                    rc = call_enter(lisp, node,
+                                    cont->i == cont->node->childnum, &value,
+                                    &done);
+                    break;
+                case TL_K_FORCE:
+                    if(cont->i){
+                        rc = TL_ERR_INTERNAL;
+                        break;
+                    }
+                    cont->i = 1;
+                    rc = call_enter(lisp, lisp->args[cont->base].node, 0,
+                                    &value, &done);
+                    break;
+                default:
+                    rc = TL_ERR_INTERNAL;
             }
         }
-    }
-    /*if(src->type == TL_T_NAME){
-        fwrite(src->items[0].string.data, 1,
-                src->items[0].string.len, stdout);
-        puts("");
-    }*/
-    if(src->type == TL_T_CALL){
-#if TL_DEBUG_CONTEXT
-        printf("Context before call: %ld\n", lisp->context);
-#endif
-        rc = call_exec(lisp, ((Node**)node->childs)[idx], dest);
         if(rc){
-            lisp->context = old_ctx;
-            if(free_returned) var_free(&returned);
+            call_unwind(lisp, root);
             return rc;
         }
-    }else{
-        rc = var_copy(src, dest);
-        if(rc){
-            lisp->context = old_ctx;
-            if(free_returned) var_free(&returned);
-            return rc;
+    }
+}
+
+void call_unwind(LizyLang *lisp, size_t root) {
+    Cont *cont;
+    size_t i;
+    /* The frames of the functions that were running are removed, so that
+     * the interpreter can run code again after an error. */
+    while(lisp->conts_cur > root){
+        cont = lisp->conts+lisp->conts_cur-1;
+        switch(cont->type){
+            case TL_K_ROOT:
+                lisp->context = cont->context;
+                break;
+            case TL_K_BUILTIN:
+                for(i=cont->base;i<lisp->values_cur;i++){
+                    var_free(lisp->values+i);
+                }
+                lisp->values_cur = cont->base;
+                break;
+            case TL_K_BODY:
+                lisp->line = ((Node**)cont->node->childs)[cont->i-1]->line;
+                call_pop(lisp);
+                break;
         }
+        lisp->conts_cur--;
     }
-    if(parse){
-        rc = call_parse_arg(lisp, dest, &parsed, context);
-        var_free(dest);
-        if(rc){
-            lisp->context = old_ctx;
-            if(free_returned) var_free(&returned);
-            return rc;
+    lisp->next = NULL;
+    lisp->tail_function = NULL;
+}
+
+int call_get_arg(LizyLang *lisp, Node *node, size_t idx, Var *dest,
+                 char parse) {
+    Node *arg;
+    if(idx >= node->childnum) return TL_ERR_TOO_FEW_ARGS;
+    arg = ((Node**)node->childs)[idx];
+    if(node == lisp->eval_node &&
+       call_preeval(lisp->eval_function, idx, arg)){
+        /* It was evaluated before calling the builtin, and it can only be
+         * taken once. */
+        var_move(lisp->values+lisp->eval_base+idx, dest);
+        if(!parse || arg->is_param) return TL_SUCCESS;
+        return call_parse_value(lisp, dest);
+    }
+    return call_eval_arg(lisp, arg, dest, parse);
+}
+
+int call_get_tail_arg(LizyLang *lisp, Node *node, size_t idx, Var *dest) {
+    Node *arg;
+    if(idx >= node->childnum) return TL_ERR_TOO_FEW_ARGS;
+    arg = ((Node**)node->childs)[idx];
+    if(arg->var->type == TL_T_CALL || arg->is_param){
+        /* The evaluator evaluates it in place of the builtin. */
+        lisp->next = arg;
+        return TL_SUCCESS;
+    }
+    return call_eval_arg(lisp, arg, dest, 1);
+}
+
+int call_eval_arg(LizyLang *lisp, Node *arg, Var *dest, char parse) {
+    int rc;
+#if TL_DEBUG_CONTEXT
+    printf("Context: %ld\n", lisp->context);
+#endif
+    if(parse && arg->is_param){
+        return call_eval(lisp, arg, dest);
+    }
+    if(arg->var->type == TL_T_CALL){
+        rc = call_eval(lisp, arg, dest);
+        if(rc) return rc;
+        if(!parse) return TL_SUCCESS;
+        return call_parse_value(lisp, dest);
+    }
+    if(parse) return call_parse_arg(lisp, arg->var, dest, lisp->context);
+    return var_copy(arg->var, dest);
+}
+
+/* A function only sees its own parameters, so only their slots in its
+ * frame are stored. The tree is walked with the parents of the nodes
+ * instead of recursing, so that it can be as deep as the tree walker
+ * allows. */
+int call_resolve(Node *node, Var *params) {
+    Node *current = node;
+    Node *parent;
+    size_t i;
+    for(;;){
+        current->has_params = 0;
+        if(current->var->type == TL_T_NAME){
+            current->is_param = 0;
+            for(i=0;VAR_LEN(current->var) == 1 && i<VAR_LEN(params);i++){
+                if(VAR_ITEMS(current->var)->symbol ==
+                   VAR_GET_ITEM(params, i).symbol){
+                    current->is_param = 1;
+                    current->slot = i;
+                    current->has_params = 1;
+                    break;
+                }
+            }
+        }else if(current->childnum){
+            current = ((Node**)current->childs)[0];
+            continue;
         }
-        rc = var_copy(&parsed, dest);
-        var_free(&parsed);
-        if(rc){
-            lisp->context = old_ctx;
-            if(free_returned) var_free(&returned);
-            return rc;
+        /* Go to the next child of the parent once a node is done, or to
+         * the parent once it is the last one. */
+        while(current != node){
+            parent = current->parent;
+            if(current->has_params) parent->has_params = 1;
+            if(current->idx+1 < parent->childnum){
+                current = ((Node**)parent->childs)[current->idx+1];
+                break;
+            }
+            current = parent;
         }
+        if(current == node) return TL_SUCCESS;
     }
-    if(free_returned) var_free(&returned);
-    lisp->context = old_ctx;
-    return TL_SUCCESS;
 }
 
 int call_get_arg_raw(Node *node, size_t idx, Var **var) {
@@ -272,11 +784,9 @@ int call_get_arg_raw(Node *node, size_t idx, Var **var) {
 }
 
 int call_parse_arg(LizyLang *lisp, Var *src, Var *dest, size_t context) {
-    char found = 0;
     int rc;
-    size_t n;
-    Function *function;
-    Var out;
+    Var *var;
+    TL_UNUSED(context);
     if(!src->size){
         dest->size = 0;
         dest->items = NULL;
@@ -286,34 +796,17 @@ int call_parse_arg(LizyLang *lisp, Var *src, Var *dest, size_t context) {
         dest->type = src->type;
     }
     if(src->type == TL_T_NAME){
-        if(!found){
-            for(n=0;n<lisp->var_num;n++){
 #if TL_DEBUG_VARS
-                fwrite(lisp->var_names[n].data, 1, lisp->var_names[n].len,
-                       stdout);
-                fputs(", ", stdout);
-                fwrite(src->items[0].string.data, 1,
-                       src->items[0].string.len, stdout);
-                fputc('\n', stdout);
+        fputs("Looking for \"", stdout);
+        fwrite(symbol_name(&lisp->symbols, VAR_ITEMS(src)->symbol)->data, 1,
+               symbol_name(&lisp->symbols, VAR_ITEMS(src)->symbol)->len,
+               stdout);
+        fputs("\"\n", stdout);
 #endif
-                if(lisp->var_names[n].len != src->items[0].string.len){
-                    continue;
-                }
-                if(!memcmp(lisp->var_names[n].data,
-                           src->items[0].string.data,
-                           lisp->var_names[n].len)){
-                    rc = var_copy(lisp->vars+n, dest);
-                    if(rc){
-                        return rc;
-                    }
-                    found = 1;
-                    break;
-                }
-            }
-        }
-        if(!found){
-            return TL_ERR_NOT_DEF;
-        }
+        rc = tl_get_var(lisp, VAR_ITEMS(src)->symbol, &var);
+        if(rc) return rc;
+        rc = var_copy(var, dest);
+        if(rc) return rc;
     }else{
         rc = var_copy(src, dest);
         if(rc){
@@ -323,4 +816,19 @@ int call_parse_arg(LizyLang *lisp, Var *src, Var *dest, size_t context) {
     return EXIT_SUCCESS;
 }
 
+/* Same as call_parse_arg, but the value is replaced, and only names are
+ * copied. */
+int call_parse_value(LizyLang *lisp, Var *value) {
+    Var parsed;
+    int rc;
+    if(value->type != TL_T_NAME) return TL_SUCCESS;
+    rc = call_parse_arg(lisp, value, &parsed, lisp->context);
+    if(rc){
+        var_free(value);
+        return rc;
+    }
+    var_free(value);
+    return var_move(&parsed, value);
+}
+
 #undef TL_MIN
@@ -40,6 +40,12 @@
  * 2024/10/09: Parse single argument with call_parse_arg.
  * 2024/10/16: Started adding calling back.
  * 2024/10/19: Adding builtin function calling back.
+ * 2026/10/18: Cache the function called by each node. Resolve the
+ *             parameters of user defined functions. Call-by-need
+ *             evaluation of the arguments. Tail calls. Evaluator with a
+ *             stack of continuations. Evaluate what a builtin returns.
+ *             Parse a value in place. Tail calls keep the frames their
+ *             arguments use.
  */
 
 #ifndef CALL_H
@@ -49,10 +55,39 @@
 #include <defs.h>
 #include <var.h>
 
+int call_find(LizyLang *lisp, Node *node, size_t symbol,
+              Function **function);
 int call_exec(LizyLang *lisp, Node *node, Var *returned);
+int call_eval(LizyLang *lisp, Node *node, Var *returned);
+int call_function(LizyLang *lisp, Node *node, Function *function,
+                  Var *returned);
+int call_eval_pending(LizyLang *lisp, Var *returned);
+int call_reserve(LizyLang *lisp, size_t n);
+int call_push(LizyLang *lisp, Node **childs, size_t childnum,
+              Function *function);
+void call_pop(LizyLang *lisp);
+int call_cont(LizyLang *lisp, unsigned char type, size_t context,
+              Cont **cont);
+int call_value(LizyLang *lisp, Var *value);
+int call_preeval(Function *function, size_t idx, Node *arg);
+int call_user(LizyLang *lisp, Node *node, Function *function, char tail);
+int call_enter(LizyLang *lisp, Node *node, char tail, Var *value,
+               char *done);
+int call_builtin(LizyLang *lisp, Var *value, char *done);
+void call_keep(LizyLang *lisp, Arg *arg, size_t low, size_t top);
+void call_move_context(LizyLang *lisp, Arg *arg, size_t low, size_t top);
+void call_drop(LizyLang *lisp, size_t base);
+int call_rebind(LizyLang *lisp, Node **childs, size_t childnum,
+                Function *function, size_t *codes);
+int call_run(LizyLang *lisp, size_t root, Var *returned);
+void call_unwind(LizyLang *lisp, size_t root);
 int call_get_arg(LizyLang *lisp, Node *node, size_t idx, Var *dest,
                  char parse);
+int call_get_tail_arg(LizyLang *lisp, Node *node, size_t idx, Var *dest);
+int call_eval_arg(LizyLang *lisp, Node *arg, Var *dest, char parse);
+int call_resolve(Node *node, Var *params);
 int call_get_arg_raw(Node *node, size_t idx, Var **var);
 int call_parse_arg(LizyLang *lisp, Var *src, Var *dest, size_t context);
+int call_parse_value(LizyLang *lisp, Var *value);
 
 #endif
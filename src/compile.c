@@ -0,0 +1,355 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Use the values folded by the
+ *             optimizer.
+ */
+
+#include <compile.h>
+#include <builtin.h>
+#include <optimize.h>
+
+int compile_form(LizyLang *lisp, Node *node, size_t *pc) {
+    Compiler c;
+    int rc;
+    c.lisp = lisp;
+    c.bc = &lisp->bc;
+    c.work = NULL;
+    c.work_cur = 0;
+    c.work_max = 0;
+    c.depth = 0;
+    *pc = c.bc->len;
+    rc = compile_value(&c, node, 0);
+    if(!rc) rc = bc_emit(c.bc, TL_OP_RETURN, 0);
+    if(!rc) rc = compile_thunks(&c);
+    free(c.work);
+    return rc;
+}
+
+int compile_body(LizyLang *lisp, Node *fncdef, size_t *pc) {
+    Compiler c;
+    Node *statement;
+    size_t i, start;
+    int rc = TL_SUCCESS;
+    char last;
+    /* The tree walker reports the statements that are not calls once it
+     * reaches them. */
+    for(i=2;i<fncdef->childnum;i++){
+        if(((Node**)fncdef->childs)[i]->var->type != TL_T_CALL){
+            fncdef->code = TL_BAD_CODE;
+            *pc = TL_BAD_CODE;
+            return TL_SUCCESS;
+        }
+    }
+    c.lisp = lisp;
+    c.bc = &lisp->bc;
+    c.work = NULL;
+    c.work_cur = 0;
+    c.work_max = 0;
+    c.depth = 0;
+    *pc = c.bc->len;
+    for(i=2;i<fncdef->childnum && !rc;i++){
+        statement = ((Node**)fncdef->childs)[i];
+        last = i == fncdef->childnum-1;
+        start = c.bc->len;
+        if(!last && OPTIMIZE_FOLDED(lisp, statement)){
+            rc = compile_skip(&c, statement);
+        }else{
+            rc = compile_value(&c, statement, last);
+            if(!rc) rc = bc_emit(c.bc, last ? TL_OP_RETURN : TL_OP_POP, 0);
+        }
+        if(!rc) rc = bc_line(c.bc, start, c.bc->len, statement->line);
+    }
+    if(!rc) rc = compile_thunks(&c);
+    free(c.work);
+    if(!rc) fncdef->code = *pc;
+    return rc;
+}
+
+/* The nodes deeper than TL_COMPILE_DEPTH are evaluated by the tree walker,
+ * that does not recurse, so that deep code does not overflow the stack of
+ * the compiler. */
+int compile_value(Compiler *c, Node *node, char tail) {
+    int rc;
+    if(c->depth >= TL_COMPILE_DEPTH) return compile_eval(c, node);
+    c->depth++;
+    rc = compile_node(c, node, tail);
+    c->depth--;
+    return rc;
+}
+
+int compile_node(Compiler *c, Node *node, char tail) {
+    Var *var;
+    Function *function;
+    Node **childs;
+    size_t idx;
+    int rc;
+    if(node->is_param){
+        return bc_emit(c->bc, TL_OP_PARAM, node->slot);
+    }
+    if(node->var->type == TL_T_NAME){
+        if(VAR_LEN(node->var) != 1) return compile_eval(c, node);
+        return bc_emit(c->bc, TL_OP_GLOBAL, VAR_ITEMS(node->var)->symbol);
+    }
+    if(node->var->type != TL_T_CALL){
+        rc = bc_const(c->bc, node->var, &idx);
+        if(rc) return rc;
+        return bc_emit(c->bc, TL_OP_CONST, idx);
+    }
+    if(OPTIMIZE_FOLDED(c->lisp, node)) return compile_folded(c, node);
+    if(VAR_LEN(node->var) != 1 || !node->var->items->call.has_func){
+        return compile_eval(c, node);
+    }
+    childs = node->childs;
+    /* The builtin that is called is known when compiling, and the guards
+     * check that it was not changed before calling it. */
+    rc = tl_get_var(c->lisp, node->var->items->call.function, &var);
+    if(rc || var->type != TL_T_FUNC || !var->items->function.builtin){
+        rc = compile_site(c, node, node->var->items->call.function, childs,
+                          node->childnum, NULL, &idx);
+        if(rc) return rc;
+        return compile_user(c, idx, tail);
+    }
+    function = &var->items->function;
+    if(function->ptr.f == builtin_if && node->childnum == 3){
+        return compile_if(c, node, function, tail);
+    }
+    if(function->ptr.f == builtin_callif && node->childnum >= 2 &&
+       childs[1]->var->type == TL_T_NAME && VAR_LEN(childs[1]->var) == 1){
+        return compile_callif(c, node, function, tail);
+    }
+    return compile_builtin(c, node, function);
+}
+
+int compile_site(Compiler *c, Node *node, size_t symbol, Node **childs,
+                 size_t childnum, Function *function, size_t *site) {
+    Site *new;
+    int rc;
+    rc = bc_site(c->bc, site);
+    if(rc) return rc;
+    new = c->bc->sites+*site;
+    new->node = node;
+    new->symbol = symbol;
+    new->childs = childs;
+    new->childnum = childnum;
+    if(function) new->function = *function;
+    return TL_SUCCESS;
+}
+
+/* The value that was folded, checked before it is used. */
+int compile_folded(Compiler *c, Node *node) {
+    size_t site, idx;
+    int rc;
+    rc = compile_site(c, node, 0, NULL, 0, NULL, &site);
+    if(rc) return rc;
+    c->bc->sites[site].fold_epoch = node->fold_epoch;
+    rc = bc_emit(c->bc, TL_OP_FOLDED, site);
+    if(rc) return rc;
+    rc = bc_const(c->bc, node->folded, &idx);
+    if(rc) return rc;
+    rc = bc_emit(c->bc, TL_OP_CONST, idx);
+    if(rc) return rc;
+    c->bc->sites[site].end = c->bc->len;
+    return TL_SUCCESS;
+}
+
+/* A folded statement whose value is not used is skipped, and only freed if
+ * it has to be evaluated. */
+int compile_skip(Compiler *c, Node *node) {
+    size_t site, jump;
+    int rc;
+    rc = compile_site(c, node, 0, NULL, 0, NULL, &site);
+    if(rc) return rc;
+    c->bc->sites[site].fold_epoch = node->fold_epoch;
+    rc = bc_emit(c->bc, TL_OP_FOLDED, site);
+    if(rc) return rc;
+    jump = c->bc->len+1;
+    rc = bc_emit(c->bc, TL_OP_JUMP, 0);
+    if(rc) return rc;
+    c->bc->sites[site].end = c->bc->len;
+    rc = bc_emit(c->bc, TL_OP_POP, 0);
+    if(rc) return rc;
+    bc_patch(c->bc, jump, c->bc->len);
+    return TL_SUCCESS;
+}
+
+int compile_eval(Compiler *c, Node *node) {
+    size_t site;
+    int rc;
+    rc = compile_site(c, node, 0, NULL, 0, NULL, &site);
+    if(rc) return rc;
+    return bc_emit(c->bc, TL_OP_EVAL, site);
+}
+
+int compile_builtin(Compiler *c, Node *node, Function *function) {
+    Node *arg;
+    size_t i, site;
+    int rc;
+    rc = compile_site(c, node, node->var->items->call.function,
+                      (Node**)node->childs, node->childnum, function, &site);
+    if(rc) return rc;
+    rc = bc_emit(c->bc, TL_OP_GUARD, site);
+    if(rc) return rc;
+    for(i=0;i<node->childnum;i++){
+        arg = ((Node**)node->childs)[i];
+        if(call_preeval(function, i, arg)){
+            rc = compile_value(c, arg, 0);
+        }else{
+            rc = bc_emit(c->bc, TL_OP_EMPTY, 0);
+        }
+        if(rc) return rc;
+    }
+    rc = bc_emit(c->bc, TL_OP_BUILTIN, site);
+    if(rc) return rc;
+    c->bc->sites[site].end = c->bc->len;
+    return TL_SUCCESS;
+}
+
+int compile_if(Compiler *c, Node *node, Function *function, char tail) {
+    Node **childs = node->childs;
+    size_t site, jump, end;
+    int rc;
+    rc = compile_site(c, node, node->var->items->call.function, childs,
+                      node->childnum, function, &site);
+    if(rc) return rc;
+    rc = bc_emit(c->bc, TL_OP_GUARD, site);
+    if(rc) return rc;
+    rc = compile_value(c, childs[0], 0);
+    if(rc) return rc;
+    if(childs[0]->var->type == TL_T_CALL && !childs[0]->is_param){
+        rc = bc_emit(c->bc, TL_OP_PARSE, 0);
+        if(rc) return rc;
+    }
+    jump = c->bc->len+1;
+    rc = bc_emit(c->bc, TL_OP_JUMPIFNOT, 0);
+    if(rc) return rc;
+    /* The branches are in tail position if the if is. */
+    rc = compile_value(c, childs[1], tail);
+    if(rc) return rc;
+    end = c->bc->len+1;
+    rc = bc_emit(c->bc, TL_OP_JUMP, 0);
+    if(rc) return rc;
+    bc_patch(c->bc, jump, c->bc->len);
+    rc = compile_value(c, childs[2], tail);
+    if(rc) return rc;
+    bc_patch(c->bc, end, c->bc->len);
+    c->bc->sites[site].end = c->bc->len;
+    return TL_SUCCESS;
+}
+
+int compile_callif(Compiler *c, Node *node, Function *function, char tail) {
+    Node **childs = node->childs;
+    Var one;
+    size_t site, call, jump, end, idx;
+    int rc;
+    rc = compile_site(c, node, node->var->items->call.function, childs,
+                      node->childnum, function, &site);
+    if(rc) return rc;
+    rc = bc_emit(c->bc, TL_OP_GUARD, site);
+    if(rc) return rc;
+    rc = compile_value(c, childs[0], 0);
+    if(rc) return rc;
+    if(childs[0]->var->type == TL_T_CALL && !childs[0]->is_param){
+        rc = bc_emit(c->bc, TL_OP_PARSE, 0);
+        if(rc) return rc;
+    }
+    jump = c->bc->len+1;
+    rc = bc_emit(c->bc, TL_OP_JUMPIFNOT, 0);
+    if(rc) return rc;
+    /* The function is called with the remaining arguments, and its name
+     * caches it. */
+    rc = compile_site(c, childs[1], VAR_ITEMS(childs[1]->var)->symbol,
+                      childs+2, node->childnum-2, NULL, &call);
+    if(rc) return rc;
+    c->bc->sites[call].callif = node;
+    rc = compile_user(c, call, tail);
+    if(rc) return rc;
+    end = c->bc->len+1;
+    rc = bc_emit(c->bc, TL_OP_JUMP, 0);
+    if(rc) return rc;
+    bc_patch(c->bc, jump, c->bc->len);
+    /* callif returns 1 if the function is not called. */
+    rc = var_int(&one, 1);
+    if(rc) return rc;
+    rc = bc_const(c->bc, &one, &idx);
+    var_free(&one);
+    if(rc) return rc;
+    rc = bc_emit(c->bc, TL_OP_CONST, idx);
+    if(rc) return rc;
+    bc_patch(c->bc, end, c->bc->len);
+    c->bc->sites[site].end = c->bc->len;
+    c->bc->sites[call].end = c->bc->len;
+    return TL_SUCCESS;
+}
+
+int compile_user(Compiler *c, size_t site, char tail) {
+    Node *arg;
+    size_t i, thunks;
+    int rc;
+    rc = bc_thunks(c->bc, c->bc->sites[site].childnum, &thunks);
+    if(rc) return rc;
+    c->bc->sites[site].thunks = thunks;
+    /* The arguments are evaluated by their own code when they are used,
+     * except the parameters that tail calls forward. */
+    for(i=0;i<c->bc->sites[site].childnum;i++){
+        arg = c->bc->sites[site].childs[i];
+        if(tail && arg->is_param) continue;
+        rc = bc_grow((void**)&c->work, &c->work_max, c->work_cur+1,
+                     sizeof(Thunk));
+        if(rc) return rc;
+        c->work[c->work_cur].node = arg;
+        c->work[c->work_cur].thunk = thunks+i;
+        c->work_cur++;
+    }
+    rc = bc_emit(c->bc, tail ? TL_OP_TAILCALL : TL_OP_CALL, site);
+    if(rc) return rc;
+    c->bc->sites[site].end = c->bc->len;
+    return TL_SUCCESS;
+}
+
+int compile_thunks(Compiler *c) {
+    Thunk thunk;
+    int rc;
+    while(c->work_cur){
+        thunk = c->work[--c->work_cur];
+        c->bc->thunks[thunk.thunk] = c->bc->len;
+        rc = compile_value(c, thunk.node, 0);
+        if(rc) return rc;
+        rc = bc_emit(c->bc, TL_OP_RETURN, 0);
+        if(rc) return rc;
+    }
+    return TL_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Depth of the compiled nodes.
+ */
+
+#ifndef COMPILE_H
+#define COMPILE_H
+
+#include <lisp.h>
+#include <bytecode.h>
+#include <defs.h>
+
+/* Argument whose code is compiled after the code that calls it, and stored
+ * at the index thunk of the thunks. */
+typedef struct {
+    Node *node;
+    size_t thunk;
+} Thunk;
+
+typedef struct {
+    LizyLang *lisp;
+    Bytecode *bc;
+    Thunk *work;
+    size_t work_cur;
+    size_t work_max;
+    /* Number of nodes that are being compiled in each other. */
+    size_t depth;
+} Compiler;
+
+int compile_form(LizyLang *lisp, Node *node, size_t *pc);
+int compile_body(LizyLang *lisp, Node *fncdef, size_t *pc);
+int compile_value(Compiler *c, Node *node, char tail);
+int compile_node(Compiler *c, Node *node, char tail);
+int compile_site(Compiler *c, Node *node, size_t symbol, Node **childs,
+                 size_t childnum, Function *function, size_t *site);
+int compile_folded(Compiler *c, Node *node);
+int compile_skip(Compiler *c, Node *node);
+int compile_eval(Compiler *c, Node *node);
+int compile_builtin(Compiler *c, Node *node, Function *function);
+int compile_if(Compiler *c, Node *node, Function *function, char tail);
+int compile_callif(Compiler *c, Node *node, Function *function, char tail);
+int compile_user(Compiler *c, size_t site, char tail);
+int compile_thunks(Compiler *c);
+
+#endif
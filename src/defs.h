@@ -44,6 +44,13 @@
  *             has no end. Added void list support.
  * 2024/10/13: Added list management functions.
  * 2024/10/16: Finish generating the tree.
+ * 2026/10/18: The stack size is the default maximum call depth. Minimum
+ *             sizes of the growable stacks of the interpreter. Value of
+ *             the code of what was not compiled. Size of the chunks in
+ *             which the code is read. Version of the interpreter. Type
+ *             of the integers, and of the other numbers. Size of the
+ *             output buffer. Size of the chunks in which the input is
+ *             read. Depth of the folded and compiled calls.
  */
 
 #ifndef DEFS_H
@@ -52,10 +59,48 @@
 #include <platform.h>
 
 #define TL_UNUSED(var) ((void)(var))
-#define TL_TOKEN_SZ    512
-#define TL_STACK_SZ    256
+/* Saved programs of another version are parsed again. */
+#define TL_VERSION     "2026.10.18"
+#define TL_TOKEN_MIN   64
+#define TL_READ_SZ     4096 /* Size of the chunks in which code is read. */
+#define TL_WRITE_SZ    4096 /* Size of the buffer of the output. */
+#define TL_INPUT_SZ    4096 /* Size of the chunks in which input is read. */
+#define TL_LINE_MIN    64
+#define TL_FOLD_DEPTH  256 /* Calls nested deeper are not folded. */
+/* Calls nested deeper are evaluated by the tree walker. */
+#define TL_COMPILE_DEPTH 256
+#define TL_STACK_SZ    256 /* Default maximum call depth. */
+#define TL_STACK_MIN   16
+#define TL_ARGS_MIN    64
+#define TL_CONTS_MIN   32
+#define TL_VALUES_MIN  64
 #define TL_FSTACK_SZ   128
 #define TL_ARGSTACK_SZ 128
+#define TL_NO_CODE     ((size_t)-1)
+
+/* Type of the integers, that can be defined with its limits to use smaller
+ * ones. The numbers that do not fit are floats. */
+#ifndef TL_INT
+#define TL_INT     long
+#define TL_INT_MAX LONG_MAX
+#define TL_INT_MIN LONG_MIN
+#endif
+
+/* Type of the other numbers: float, double if TL_DOUBLE is defined, or for
+ * CPUs without FPU fixed point numbers with TL_FIXED bits after the point,
+ * stored in a TL_FIXED_T, that can be defined with its limits. */
+#if defined(TL_FIXED)
+#ifndef TL_FIXED_T
+#define TL_FIXED_T   long
+#define TL_FIXED_MAX LONG_MAX
+#define TL_FIXED_MIN LONG_MIN
+#endif
+#define TL_FLOAT     TL_FIXED_T
+#elif defined(TL_DOUBLE)
+#define TL_FLOAT     double
+#else
+#define TL_FLOAT     float
+#endif
 
 enum {
     TL_SUCCESS,
@@ -83,6 +128,7 @@ enum {
     TL_ERR_BAD_INPUT,
     TL_ERR_OUT_OF_RANGE,
     TL_ERR_VALUE_OUTSIDE_OF_CALL,
+    TL_ERR_WRITE,
     TL_RC_AMOUNT
 };
 
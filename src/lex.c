@@ -0,0 +1,116 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file.
+ */
+
+#include <lex.h>
+
+#if TL_LEX_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Returns the index of the first character between start and end that
+ * ends the span, or end if there is none. */
+size_t lex_span_bytes(char *data, size_t start, size_t end, char in_string,
+                      size_t *lines) {
+    size_t i;
+    char c;
+    for(i=start;i<end;i++){
+        c = data[i];
+        if(c == '\\' || c == '"') break;
+        if(c == '\n'){
+            if(!in_string) break;
+            (*lines)++;
+        }
+        if(!in_string && (c == '(' || c == ')' || c == ' ' || c == '\t')){
+            break;
+        }
+    }
+    return i;
+}
+
+/* Returns the number of characters at the start of data that the parser
+ * adds to the current token without handling them separately, and adds the
+ * number of newlines in them to lines. In a string, only the backslashes
+ * and the quotes end the span, outside of a string the parentheses, spaces,
+ * tabs and newlines end it too. */
+size_t lex_span(char *data, size_t len, char in_string, size_t *lines) {
+    size_t i;
+#if TL_LEX_SSE2
+    __m128i chunk, special;
+    __m128i backslash, quote, open, close, space, tab, newline;
+    unsigned int mask, before;
+    /* Most names and numbers are short, so look at the first characters one
+     * by one before setting up the vectors. */
+    i = lex_span_bytes(data, 0, len < 16 ? len : 16, in_string, lines);
+    if(i < 16) return i;
+    backslash = _mm_set1_epi8('\\');
+    quote = _mm_set1_epi8('"');
+    open = _mm_set1_epi8('(');
+    close = _mm_set1_epi8(')');
+    space = _mm_set1_epi8(' ');
+    tab = _mm_set1_epi8('\t');
+    newline = _mm_set1_epi8('\n');
+    /* Classify 16 characters at once. */
+    for(;i+16<=len;i+=16){
+        chunk = _mm_loadu_si128((__m128i*)(data+i));
+        special = _mm_or_si128(_mm_cmpeq_epi8(chunk, backslash),
+                               _mm_cmpeq_epi8(chunk, quote));
+        if(!in_string){
+            special = _mm_or_si128(special,
+                                   _mm_or_si128(_mm_cmpeq_epi8(chunk, open),
+                                                _mm_cmpeq_epi8(chunk, close)));
+            special = _mm_or_si128(special,
+                                   _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                _mm_cmpeq_epi8(chunk, tab)));
+            special = _mm_or_si128(special,
+                                   _mm_cmpeq_epi8(chunk, newline));
+        }
+        mask = _mm_movemask_epi8(special);
+        before = mask ? (1U<<__builtin_ctz(mask))-1 : 0xFFFFU;
+        if(in_string){
+            *lines += __builtin_popcount(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline))&before);
+        }
+        if(mask) return i+__builtin_ctz(mask);
+    }
+#else
+    i = 0;
+#endif
+    return lex_span_bytes(data, i, len, in_string, lines);
+}
@@ -53,6 +53,26 @@
  * 2024/10/19: Handle errors when calling functions. Fixed error handling.
  * 2024/10/20: Fixed line number in error message. New stack.
  * 2024/10/21: Perform calls in the right context.
+ * 2026/10/18: Store the global variables in a hash table. Intern the names
+ *             when parsing. Invalidate the call caches when a function
+ *             changes. Free the evaluated arguments of the stack. Tail
+ *             calls. Maximum call depth set at runtime. Free the
+ *             continuations and values of the evaluator. Compile the
+ *             tree to bytecode and run it. Move variables to the globals.
+ *             Keep the value of the last expression. Allocate the tree in
+ *             blocks. Read the code in chunks, run each statement once it
+ *             is parsed and free it. Add the characters that need no handling
+ *             to the tokens at once. Tokens are used where they are in the
+ *             code, only copied when needed, and have no maximum size.
+ *             Store the parsed code in a program, and run saved programs.
+ *             Compile the code to a program without running it. Values
+ *             folded by the optimizer are computed again once a variable
+ *             they depend on changes. Integers and floats can be set to
+ *             each other. The output is buffered, and flushed before
+ *             reading code and errors. Saved programs that end more
+ *             calls than they start are rejected. String literals are
+ *             views of the code. Saved programs are checked before
+ *             running any of their statements.
  */
 
 #include <lisp.h>
@@ -60,16 +80,58 @@
 #include <call.h>
 #include <builtin.h>
 #include <tree.h>
+#include <compile.h>
+#include <vm.h>
+#include <lex.h>
 
+/* The code in buffer has to stay valid until tl_free, the strings of the
+ * code point into it. */
 int tl_init(LizyLang *lisp, char *buffer, size_t sz) {
     lisp->buffer = buffer;
     lisp->sz = sz;
-    lisp->var_num = 0;
-    lisp->vars = NULL;
-    lisp->var_names = NULL;
+    lisp->read = NULL;
+    lisp->read_data = NULL;
+    lisp->out_len = 0;
+    tl_set_output(lisp, stdout);
+    lisp->in_pos = 0;
+    lisp->in_len = 0;
+    lisp->in_end = 0;
+    tl_set_input(lisp, stdin);
+    lisp->in_line = NULL;
+    lisp->in_line_max = 0;
+    lisp->token = NULL;
+    lisp->token_max = 0;
+    lisp->program = NULL;
+    lisp->run = 1;
+    table_init(&lisp->vars);
+    symbol_init(&lisp->symbols);
+    lisp->stack = NULL;
     lisp->stack_cur = 0;
+    lisp->stack_max = 0;
+    lisp->max_depth = TL_STACK_SZ;
+    lisp->args = NULL;
+    lisp->args_cur = 0;
+    lisp->args_max = 0;
     lisp->fstack_cur = 0;
     lisp->argstack_cur = 0;
+    lisp->epoch = 1;
+    lisp->fold_epoch = 1;
+    lisp->cache_hits = 0;
+    lisp->cache_misses = 0;
+    lisp->conts = NULL;
+    lisp->conts_cur = 0;
+    lisp->conts_max = 0;
+    lisp->values = NULL;
+    lisp->values_cur = 0;
+    lisp->values_max = 0;
+    lisp->eval_function = NULL;
+    lisp->eval_node = NULL;
+    lisp->eval_base = 0;
+    lisp->next = NULL;
+    lisp->tail_function = NULL;
+    bc_init(&lisp->bc);
+    lisp->bytecode = 1;
+    tree_init(&lisp->tree);
     node_init(&lisp->node, NULL);
     lisp->node.line = 0;
 #if TL_LEAK_CHECK
@@ -79,62 +141,411 @@ int tl_init(LizyLang *lisp, char *buffer, size_t sz) {
     return var_num_from_float(&lisp->last, 0);
 }
 
-#define TL_ERROR(err) error((char*)messages[err], data); return err
-#define TL_TOK_ADD(c) token[token_cur++] = c; \
-                      if(token_cur >= TL_TOKEN_SZ){ \
-                          TL_ERROR(TL_ERR_TOKFULL); \
-                          return TL_ERR_TOKFULL; \
+const char *lisp_messages[TL_RC_AMOUNT] = {
+    "Unknown error!",
+    "Token full!",
+    "Missing function!",
+    "String outside of call!",
+    "Out of memory!",
+    "Mem. copy error!",
+    "FStack overflow!",
+    "Extra parenthesis!",
+    "Argstack overflow!",
+    "Internal error, please report it!",
+    "Unknown type!",
+    "Name not defined!",
+    "Function not defined!",
+    "Too few arguments!",
+    "Too many arguments!",
+    "Bad type!",
+    "Invalid list size!",
+    "Already defined name!",
+    "Function definition not ended!",
+    "Invalid name!",
+    "Stack overflow!",
+    "Division by zero!",
+    "Bad input!",
+    "Index out of range!",
+    "Value outside of call!",
+    "Write error!"
+};
+
+#define TL_ERROR(err) tl_flush(lisp); \
+                      error((char*)lisp_messages[err], data); \
+                      return err
+#define TL_TOK_ADD(c) added = c; \
+                      rc = lisp_token_add(lisp, &token, &token_cur, \
+                                          &added, 1); \
+                      if(rc){ \
+                          TL_ERROR(rc); \
                       }
 
+int tl_set_max_depth(LizyLang *lisp, size_t depth) {
+    if(!depth) return TL_ERR_OUT_OF_RANGE;
+    lisp->max_depth = depth;
+    return TL_SUCCESS;
+}
+
+int tl_set_bytecode(LizyLang *lisp, char bytecode) {
+    lisp->bytecode = bytecode;
+    return TL_SUCCESS;
+}
+
+int tl_set_reader(LizyLang *lisp, size_t read(char*, size_t, void*),
+                  void *data) {
+    lisp->read = read;
+    lisp->read_data = data;
+    return TL_SUCCESS;
+}
+
+size_t lisp_read_file(char *buffer, size_t sz, void *fp) {
+    return fread(buffer, 1, sz, fp);
+}
+
+int tl_set_file(LizyLang *lisp, FILE *fp) {
+    return tl_set_reader(lisp, lisp_read_file, fp);
+}
+
+/* The output is written by write, that returns how much of it it wrote. */
+int tl_set_writer(LizyLang *lisp, size_t write(char*, size_t, void*),
+                  void *data) {
+    lisp->write = write;
+    lisp->write_data = data;
+    return TL_SUCCESS;
+}
+
+size_t lisp_write_file(char *buffer, size_t sz, void *fp) {
+    return fwrite(buffer, 1, sz, fp);
+}
+
+int tl_set_output(LizyLang *lisp, FILE *fp) {
+    return tl_set_writer(lisp, lisp_write_file, fp);
+}
+
+/* Data that does not fit in the buffer once it is flushed is written
+ * directly. */
+int tl_write(LizyLang *lisp, char *data, size_t len) {
+    int rc;
+    if(lisp->out_len+len > TL_WRITE_SZ){
+        rc = tl_flush(lisp);
+        if(rc) return rc;
+        if(len > TL_WRITE_SZ){
+            if(lisp->write(data, len, lisp->write_data) != len){
+                return TL_ERR_WRITE;
+            }
+            return TL_SUCCESS;
+        }
+    }
+    memcpy(lisp->out+lisp->out_len, data, len);
+    lisp->out_len += len;
+    return TL_SUCCESS;
+}
+
+int tl_putc(LizyLang *lisp, char c) {
+    int rc;
+    if(lisp->out_len == TL_WRITE_SZ){
+        rc = tl_flush(lisp);
+        if(rc) return rc;
+    }
+    lisp->out[lisp->out_len++] = c;
+    return TL_SUCCESS;
+}
+
+/* The buffer is emptied even if it could not be written. */
+int tl_flush(LizyLang *lisp) {
+    size_t len = lisp->out_len;
+    lisp->out_len = 0;
+    if(!len) return TL_SUCCESS;
+    if(lisp->write(lisp->out, len, lisp->write_data) != len){
+        return TL_ERR_WRITE;
+    }
+    return TL_SUCCESS;
+}
+
+/* The input is read by input, that returns how much of it it read, and 0
+ * at its end. */
+int tl_set_input_reader(LizyLang *lisp, size_t input(char*, size_t, void*),
+                        void *data) {
+    lisp->input = input;
+    lisp->input_data = data;
+    lisp->in_pos = 0;
+    lisp->in_len = 0;
+    lisp->in_end = 0;
+    return TL_SUCCESS;
+}
+
+/* Reads at most a line, so that an interactive input is not waited for
+ * after it. fgets already reads the file in large blocks, but a line is
+ * cut at a null character. */
+size_t lisp_input_file(char *buffer, size_t sz, void *fp) {
+    if(!fgets(buffer, sz, fp)) return 0;
+    return strlen(buffer);
+}
+
+int tl_set_input(LizyLang *lisp, FILE *fp) {
+    return tl_set_input_reader(lisp, lisp_input_file, fp);
+}
+
+/* Adds the input from in_pos to end to the line that is copied. */
+int lisp_line_add(LizyLang *lisp, size_t *len, size_t end) {
+    char *tmp;
+    size_t max = lisp->in_line_max;
+    size_t n = end-lisp->in_pos;
+    while(*len+n > max){
+        max = max ? max*2 : TL_LINE_MIN;
+    }
+    if(max > lisp->in_line_max){
+        tmp = realloc(lisp->in_line, max);
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+        lisp->in_line = tmp;
+        lisp->in_line_max = max;
+    }
+    if(n) memcpy(lisp->in_line+*len, lisp->in+lisp->in_pos, n);
+    *len += n;
+    lisp->in_pos = end;
+    return TL_SUCCESS;
+}
+
+/* Reads the next line of the input, without its newline, into a string.
+ * At the end of the input, line is an empty list of strings. */
+int tl_read_line(LizyLang *lisp, Var *line) {
+    size_t len = 0;
+    char *end;
+    int rc;
+    for(;;){
+        end = memchr(lisp->in+lisp->in_pos, '\n', lisp->in_len-lisp->in_pos);
+        if(end && !len){
+            /* The whole line is in the chunk. */
+            rc = var_str(line, lisp->in+lisp->in_pos,
+                         end-(lisp->in+lisp->in_pos));
+            lisp->in_pos = (size_t)(end-lisp->in)+1;
+            return rc;
+        }
+        rc = lisp_line_add(lisp, &len, end ? (size_t)(end-lisp->in) :
+                           lisp->in_len);
+        if(rc) return rc;
+        if(end){
+            lisp->in_pos++;
+            break;
+        }
+        lisp->in_pos = 0;
+        lisp->in_len = 0;
+        if(!lisp->in_end){
+            lisp->in_len = lisp->input(lisp->in, TL_INPUT_SZ,
+                                       lisp->input_data);
+        }
+        if(!lisp->in_len){
+            lisp->in_end = 1;
+            if(len) break;
+            line->null = 0;
+            line->size = 0;
+            line->items = NULL;
+            line->type = TL_T_STR;
+            return TL_SUCCESS;
+        }
+    }
+    return var_str(line, lisp->in_line, len);
+}
+
+/* The code that tl_run parses is added to the program, that can then be
+ * saved with program_save. */
+int tl_set_program(LizyLang *lisp, Program *program) {
+    lisp->program = program;
+    return TL_SUCCESS;
+}
+
+/* Adds len characters to the token. If it is still a part of the code, it
+ * is copied to the token buffer first. */
+int lisp_token_add(LizyLang *lisp, char **token, size_t *token_cur,
+                   char *data, size_t len) {
+    char *tmp;
+    size_t max = lisp->token_max;
+    while(*token_cur+len > max){
+        max = max ? max*2 : TL_TOKEN_MIN;
+    }
+    if(max > lisp->token_max){
+        tmp = realloc(lisp->token, max);
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+        if(*token == lisp->token) *token = tmp;
+        lisp->token = tmp;
+        lisp->token_max = max;
+    }
+    if(*token != lisp->token){
+        if(*token_cur) memcpy(lisp->token, *token, *token_cur);
+        *token = lisp->token;
+    }
+    if(len) memcpy(lisp->token+*token_cur, data, len);
+    *token_cur += len;
+    return TL_SUCCESS;
+}
+
+int lisp_run_statement(LizyLang *lisp, Node *node, TreeMark *mark) {
+    BytecodeMark code;
+    Var returned;
+    size_t line, epoch, pc, end = 0;
+    int rc;
+    /* The parser continues from this line. */
+    line = lisp->line;
+    lisp->line = node->line;
+    lisp->context = 0;
+    epoch = lisp->epoch;
+    bc_mark(&lisp->bc, &code);
+    if(lisp->bytecode){
+        rc = compile_form(lisp, node, &pc);
+        end = lisp->bc.len;
+        if(!rc) rc = vm_run(lisp, pc, &returned);
+    }else{
+        rc = call_exec(lisp, node, &returned);
+    }
+    if(rc) return rc;
+    lisp->line = line;
+    var_free(&lisp->last);
+    var_move(&returned, &lisp->last);
+    /* The code of the statement is not run again, it is freed unless the
+     * body of a function was compiled after it. */
+    if(lisp->bytecode && lisp->bc.len == end) bc_release(&lisp->bc, &code);
+    /* The statement is kept if a function was defined, since its body may
+     * be in it. */
+    if(lisp->epoch == epoch) tree_release(&lisp->tree, mark);
+    return TL_SUCCESS;
+}
+
+/* Starts a call. If it is a statement, what is allocated from there is
+ * freed once it ran. */
+int lisp_open_call(LizyLang *lisp, Node **current, TreeMark *mark) {
+    Node *allocated;
+    int rc;
+    if(lisp->program){
+        rc = program_open(lisp->program, lisp->line);
+        if(rc) return rc;
+    }
+    if(*current == &lisp->node) tree_mark(&lisp->tree, mark);
+    rc = tree_call(&lisp->tree, &allocated);
+    if(rc) return rc;
+    allocated->line = lisp->line;
+    /* The statements are run once they end, and not kept in the root. The
+     * childs of a call are stored once it ends. */
+    if(*current == &lisp->node){
+        allocated->parent = *current;
+    }else{
+        rc = tree_add_child(&lisp->tree, *current, allocated);
+        if(rc) return rc;
+    }
+    *current = allocated;
+    return TL_SUCCESS;
+}
+
+int lisp_set_func(LizyLang *lisp, Node *current, size_t symbol) {
+    int rc;
+    if(lisp->program){
+        rc = program_func(lisp->program, symbol);
+        if(rc) return rc;
+    }
+    current->var->items->call.function = symbol;
+    current->var->items->call.has_func = 1;
+    return TL_SUCCESS;
+}
+
+/* Adds a value to the current call. The value is empty if it succeeds, and
+ * freed otherwise. */
+int lisp_add_value(LizyLang *lisp, Node *current, Var *value) {
+    Node *allocated;
+    int rc = TL_SUCCESS;
+    if(lisp->program) rc = program_value(lisp->program, value, lisp->line);
+    if(!rc) rc = tree_node(&lisp->tree, &allocated);
+    if(rc){
+        var_free(value);
+        return rc;
+    }
+    var_move(value, allocated->var);
+    allocated->line = lisp->line;
+    return tree_add_child(&lisp->tree, current, allocated);
+}
+
+/* Ends the current call, and runs it if it is a statement, unless the code
+ * is only compiled. */
+int lisp_close_call(LizyLang *lisp, Node **current, TreeMark *mark) {
+    Node *node = *current;
+    int rc;
+    if(lisp->program){
+        rc = program_close(lisp->program);
+        if(rc) return rc;
+    }
+    rc = tree_end(&lisp->tree, node);
+    if(rc) return rc;
+    *current = node->parent;
+    if(*current != &lisp->node) return TL_SUCCESS;
+    if(!lisp->run){
+        tree_release(&lisp->tree, mark);
+        return TL_SUCCESS;
+    }
+    return lisp_run_statement(lisp, node, mark);
+}
+
 int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
     char c;
-    char token[TL_TOKEN_SZ];
+    char *token = NULL;
     size_t token_cur = 0;
     char in_string = 0;
     char escaped = 0;
     char in_hex = 0;
-    char hexnum;
+    char hexnum = 0;
+    char added;
     int rc;
-    size_t i;
-    Node *allocated;
+    size_t i, n;
+    size_t symbol;
+    char chunk[TL_READ_SZ];
+    char *buffer = lisp->buffer;
+    size_t sz = lisp->sz;
     Node *current = &lisp->node;
-    Node *node;
-    Var *node_data;
-    Var returned;
-    const char *messages[TL_RC_AMOUNT] = {
-        "Unknown error!",
-        "Token full!",
-        "Missing function!",
-        "String outside of call!",
-        "Out of memory!",
-        "Mem. copy error!",
-        "FStack overflow!",
-        "Extra parenthesis!",
-        "Argstack overflow!",
-        "Internal error, please report it!",
-        "Unknown type!",
-        "Name not defined!",
-        "Function not defined!",
-        "Too few arguments!",
-        "Too many arguments!",
-        "Bad type!",
-        "Invalid list size!",
-        "Already defined name!",
-        "Function definition not ended!",
-        "Invalid name!",
-        "Stack overflow!",
-        "Division by zero!",
-        "Bad input!",
-        "Index out of range!",
-        "Value outside of call!"
-    };
+    Var value;
+    TreeMark mark;
     lisp->line = 1;
-    for(i=0;i<lisp->sz;i++){
-        c = lisp->buffer[i];
+    if(lisp->read) sz = 0;
+    for(i=0;;i++){
+        if(i >= sz){
+            /* Read the next chunk of code. */
+            if(!lisp->read) break;
+            /* The token is copied before the chunk is overwritten. */
+            if(token_cur){
+                rc = lisp_token_add(lisp, &token, &token_cur, NULL, 0);
+                if(rc){
+                    TL_ERROR(rc);
+                }
+            }
+            rc = tl_flush(lisp);
+            if(rc){
+                TL_ERROR(rc);
+            }
+            sz = lisp->read(chunk, TL_READ_SZ, lisp->read_data);
+            if(!sz) break;
+            buffer = chunk;
+            i = 0;
+        }
+        c = buffer[i];
 #if TL_DEBUG_CHAR
         printf("%ld%ld, %c\n", lisp->fstack_cur,
                lisp->fstack[lisp->fstack_cur].argstack_cur, c);
 #endif
+        if(!escaped && !in_hex){
+            /* Add the characters that need no handling at once. */
+            n = lex_span(buffer+i, sz-i, in_string, &lisp->line);
+            if(n){
+                if(token_cur){
+                    rc = lisp_token_add(lisp, &token, &token_cur, buffer+i,
+                                        n);
+                    if(rc){
+                        TL_ERROR(rc);
+                    }
+                }else{
+                    /* The token starts here, it is not copied. */
+                    token = buffer+i;
+                    token_cur = n;
+                }
+                i += n-1;
+                continue;
+            }
+        }
         if(c == '\\' && !escaped){
             escaped = 1;
             continue;
@@ -160,30 +571,20 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
                                 fwrite(token, 1, token_cur, stdout);
                                 puts("\"");
 #endif
-                                allocated = malloc(sizeof(Node));
-                                if(!allocated){
-                                    TL_ERROR(TL_ERR_OUT_OF_MEM);
-                                }
-                                node_data = malloc(sizeof(Node));
-                                if(!node_data){
-                                    free(allocated);
-                                    TL_ERROR(TL_ERR_OUT_OF_MEM);
-                                }
-                                rc = var_auto(node_data, token, token_cur);
-                                if(rc){
-                                    TL_ERROR(rc);
+                                if(var_isnum(token, token_cur)){
+                                    rc = var_num(&value, token, token_cur);
+                                }else if(var_isname(token, token_cur)){
+                                    rc = tl_intern(lisp, token, token_cur,
+                                                   &symbol);
+                                    if(!rc) rc = var_name(&value, symbol);
+                                }else{
+                                    rc = TL_ERR_UNKNOWN_TYPE;
                                 }
-                                rc = node_init(allocated, node_data);
-                                if(rc){
-                                    free(allocated);
-                                    free(node_data);
-                                    TL_ERROR(rc);
+                                if(!rc){
+                                    rc = lisp_add_value(lisp, current,
+                                                        &value);
                                 }
-                                allocated->line = lisp->line;
-                                rc = node_add_child(current, allocated);
                                 if(rc){
-                                    free(allocated);
-                                    free(node_data);
                                     TL_ERROR(rc);
                                 }
                             }else{
@@ -193,10 +594,15 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
                                 fwrite(token, 1, token_cur, stdout);
                                 puts("\"");
     #endif
-                                var_free_str(&current->var->items->call.function);
-                                var_raw_str(&current->var->items->call.function,
-                                            token, token_cur);
-                                current->var->items->call.has_func = 1;
+                                rc = tl_intern(lisp, token, token_cur,
+                                               &symbol);
+                                if(!rc){
+                                    rc = lisp_set_func(lisp, current,
+                                                       symbol);
+                                }
+                                if(rc){
+                                    TL_ERROR(rc);
+                                }
                             }
                             token_cur = 0;
                         }
@@ -206,33 +612,10 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
                 }
                 if(c == '('){
                     /* Create new call. */
-                    allocated = malloc(sizeof(Node));
-                    if(!allocated){
-                        TL_ERROR(TL_ERR_OUT_OF_MEM);
-                    }
-                    node_data = malloc(sizeof(Node));
-                    if(!node_data){
-                        free(allocated);
-                        TL_ERROR(TL_ERR_OUT_OF_MEM);
-                    }
-                    rc = var_call(node_data, "", 0);
-                    if(rc){
-                        TL_ERROR(rc);
-                    }
-                    rc = node_init(allocated, node_data);
-                    if(rc){
-                        free(allocated);
-                        free(node_data);
-                        TL_ERROR(rc);
-                    }
-                    allocated->line = lisp->line;
-                    rc = node_add_child(current, allocated);
+                    rc = lisp_open_call(lisp, &current, &mark);
                     if(rc){
-                        free(allocated);
-                        free(node_data);
                         TL_ERROR(rc);
                     }
-                    current = allocated;
                     token_cur = 0;
 #if TL_DEBUG_TREE
                     puts("-> New node");
@@ -244,14 +627,17 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
                     if(current == &lisp->node){
                         TL_ERROR(TL_ERR_END_PARANTHESIS);
                     }
-                    current = current->parent;
 #if TL_DEBUG_TREE
-                    if(current == &lisp->node){
+                    if(current->parent == &lisp->node){
                         puts("<- Go to the root node");
                     }else{
                         puts("<- Go to the parent node");
                     }
 #endif
+                    rc = lisp_close_call(lisp, &current, &mark);
+                    if(rc){
+                        TL_ERROR(rc);
+                    }
                 }
             }else{
                 if(c == '"'){
@@ -265,31 +651,16 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
                     if(current == &lisp->node){
                         TL_ERROR(TL_ERR_STR_OUT_OF_CALL);
                     }
-                    /* Add a node for the value */
-                    allocated = malloc(sizeof(Node));
-                    if(!allocated){
-                        TL_ERROR(TL_ERR_OUT_OF_MEM);
-                    }
-                    node_data = malloc(sizeof(Node));
-                    if(!node_data){
-                        free(allocated);
-                        TL_ERROR(TL_ERR_OUT_OF_MEM);
-                    }
-                    rc = var_str(node_data, token, token_cur);
-                    if(rc){
-                        TL_ERROR(rc);
-                    }
-                    rc = node_init(allocated, node_data);
-                    if(rc){
-                        free(allocated);
-                        free(node_data);
-                        TL_ERROR(rc);
+                    /* Add a node for the value. When the code is kept until
+                     * tl_free and the string is not copied, it is a view of
+                     * the code. */
+                    if(!lisp->read && lisp->run && token != lisp->token){
+                        rc = var_str_view(&value, token, token_cur);
+                    }else{
+                        rc = var_str(&value, token, token_cur);
                     }
-                    allocated->line = lisp->line;
-                    rc = node_add_child(current, allocated);
+                    if(!rc) rc = lisp_add_value(lisp, current, &value);
                     if(rc){
-                        free(allocated);
-                        free(node_data);
                         TL_ERROR(rc);
                     }
                     token_cur = 0;
@@ -348,55 +719,159 @@ int tl_run(LizyLang *lisp, void error(char*, void*), void *data) {
         }
         escaped = 0;
     }
-    for(i=0;i<lisp->node.childnum;i++){
-        node = ((Node**)lisp->node.childs)[i];
-        lisp->line = node->line;
-        lisp->context = 0;
-        rc = call_exec(lisp, node, &returned);
+    /* End the calls that are not closed, and run the statement. */
+    while(current != &lisp->node){
+        rc = lisp_close_call(lisp, &current, &mark);
         if(rc){
             TL_ERROR(rc);
         }
-        var_free(&returned);
+    }
+    rc = tl_flush(lisp);
+    if(rc){
+        TL_ERROR(rc);
     }
     return TL_SUCCESS;
 }
 
-#undef TL_TOK_ADD
-#undef TL_ERROR
-
-void lisp_free_nodes(Node *node, void *_lisp) {
-    LizyLang *lisp = _lisp;
-    free(node->var);
-    node->var = NULL;
-    if(node != &lisp->node) free(node);
+/* Parses the code without running it. The program can then be run with
+ * tl_exec, by this interpreter or another one. */
+int tl_compile(LizyLang *lisp, char *code, size_t sz, Program *program,
+               void error(char*, void*), void *data) {
+    char *buffer = lisp->buffer;
+    size_t buffer_sz = lisp->sz;
+    size_t (*read)(char*, size_t, void*) = lisp->read;
+    Program *recorded = lisp->program;
+    int rc;
+    program_init(program);
+    lisp->buffer = code;
+    lisp->sz = sz;
+    lisp->read = NULL;
+    lisp->program = program;
+    lisp->run = 0;
+    rc = tl_run(lisp, error, data);
+    lisp->buffer = buffer;
+    lisp->sz = buffer_sz;
+    lisp->read = read;
+    lisp->program = recorded;
+    lisp->run = 1;
+    if(!rc){
+        rc = program_set_symbols(program, &lisp->symbols);
+        if(rc) error((char*)lisp_messages[rc], data);
+    }
+    if(rc) program_free(program);
+    return rc;
 }
 
-int tl_free(LizyLang *lisp) {
-    size_t i, n;
-    int out = TL_SUCCESS;
-    for(i=0;i<lisp->stack_cur;i++){
-        if(((Node*)lisp->stack[i].function->ptr.fncdef)->childnum){
-            if(lisp->stack[i].evaluated){
-                for(n=0;n<((Node**)((Node*)lisp->stack[i].function->ptr.fncdef)
-                           ->childs)[1]->childnum;n++){
-                    if(lisp->stack[i].evaluated[n]){
-                        var_free(lisp->stack[i].args+n);
-                    }
-                }
+/* Runs a program as tl_run would run the code it was parsed from, without
+ * parsing it again. */
+int tl_exec(LizyLang *lisp, Program *program, void error(char*, void*),
+            void *data) {
+    size_t cur = 0;
+    size_t i, num;
+    size_t *symbols;
+    String name;
+    Event event;
+    Node *current = &lisp->node;
+    Var value;
+    TreeMark mark;
+    int rc;
+    /* Nothing runs if a part of the program is malformed. */
+    rc = program_validate(program);
+    if(!rc){
+        rc = program_read_num(program->names, program->names_len, &cur,
+                              &num);
+    }
+    if(rc){
+        TL_ERROR(rc);
+    }
+    /* The symbols may not have the same numbers in this interpreter. */
+    symbols = malloc((num ? num : 1)*sizeof(size_t));
+    if(!symbols){
+        TL_ERROR(TL_ERR_OUT_OF_MEM);
+    }
+    for(i=0;i<num;i++){
+        rc = program_read_str(program->names, program->names_len, &cur,
+                              &name);
+        if(!rc) rc = tl_intern(lisp, name.data, name.len, symbols+i);
+        if(rc) break;
+    }
+    cur = 0;
+    event.line = 1;
+    while(!rc && cur < program->len){
+        rc = program_next(program->data, program->len, &cur, &event);
+        if(rc) break;
+        if(event.type != TL_P_FUNC && event.type != TL_P_CLOSE){
+            lisp->line = event.line;
+        }
+        if(event.type == TL_P_OPEN){
+            rc = lisp_open_call(lisp, &current, &mark);
+            continue;
+        }
+        if(event.type == TL_P_CLOSE){
+            /* A call that was not opened would end the root. */
+            if(current == &lisp->node) rc = TL_ERR_BAD_INPUT;
+            else rc = lisp_close_call(lisp, &current, &mark);
+            continue;
+        }
+        if(current == &lisp->node){
+            rc = TL_ERR_BAD_INPUT;
+        }else if((event.type == TL_P_FUNC || event.type == TL_P_NAME) &&
+                 event.symbol >= num){
+            rc = TL_ERR_BAD_INPUT;
+        }else if(event.type == TL_P_FUNC){
+            rc = lisp_set_func(lisp, current, symbols[event.symbol]);
+        }else{
+            if(event.type == TL_P_NUM){
+                rc = var_num_from_float(&value, event.num);
+            }else if(event.type == TL_P_INT){
+                rc = var_int(&value, event.integer);
+            }else if(event.type == TL_P_STR){
+                rc = var_str(&value, event.string.data, event.string.len);
+            }else{
+                rc = var_name(&value, symbols[event.symbol]);
             }
-            free(lisp->stack[i].args);
-            lisp->stack[i].args = NULL;
-            free(lisp->stack[i].evaluated);
-            lisp->stack[i].evaluated = NULL;
+            if(!rc) rc = lisp_add_value(lisp, current, &value);
         }
     }
-    for(i=0;i<lisp->var_num;i++){
-        var_free(lisp->vars+i);
-        var_free_str(lisp->var_names+i);
+    free(symbols);
+    if(!rc && current != &lisp->node) rc = TL_ERR_BAD_INPUT;
+    if(!rc) rc = tl_flush(lisp);
+    if(rc){
+        TL_ERROR(rc);
+    }
+    return TL_SUCCESS;
+}
+
+#undef TL_TOK_ADD
+#undef TL_ERROR
+
+int tl_free(LizyLang *lisp) {
+    size_t i;
+    int out = tl_flush(lisp);
+    for(i=0;i<lisp->args_cur;i++){
+        if(lisp->args[i].evaluated) var_free(&lisp->args[i].value);
+    }
+    free(lisp->args);
+    lisp->args = NULL;
+    free(lisp->stack);
+    lisp->stack = NULL;
+    for(i=0;i<lisp->values_cur;i++){
+        var_free(lisp->values+i);
     }
-    node_free_childs(&lisp->node, lisp_free_nodes, lisp);
-    free(lisp->vars);
-    free(lisp->var_names);
+    free(lisp->values);
+    lisp->values = NULL;
+    free(lisp->conts);
+    lisp->conts = NULL;
+    free(lisp->token);
+    lisp->token = NULL;
+    free(lisp->in_line);
+    lisp->in_line = NULL;
+    bc_free(&lisp->bc);
+    table_free(&lisp->vars);
+    tree_free(&lisp->tree);
+    free(lisp->node.childs);
+    lisp->node.childs = NULL;
+    symbol_free(&lisp->symbols);
     var_free(&lisp->last);
 #if TL_LEAK_CHECK
     muntrace();
@@ -404,89 +879,75 @@ int tl_free(LizyLang *lisp) {
     return out;
 }
 
-int tl_add_var(LizyLang *lisp, Var *var, String *name) {
-    Var *var_ptr;
-    String *name_ptr;
-    size_t i;
-    for(i=0;i<lisp->var_num;i++){
-        if(lisp->var_names[i].len != name->len) continue;
-        if(!memcmp(name->data, lisp->var_names[i].data, name->len)){
-            return TL_ERR_NAME_EXISTS;
-        }
-    }
-    lisp->var_num++;
-    var_ptr = realloc(lisp->vars, lisp->var_num*sizeof(Var));
-    if(!var_ptr){
-        lisp->var_num--;
-        return TL_ERR_OUT_OF_MEM;
-    }
-    lisp->vars = var_ptr;
-    name_ptr = realloc(lisp->var_names, lisp->var_num*sizeof(String));
-    if(!name_ptr){
-        lisp->var_num--;
-        return TL_ERR_OUT_OF_MEM;
-    }
-    lisp->var_names = name_ptr;
-    lisp->vars[lisp->var_num-1] = *var;
-    lisp->var_names[lisp->var_num-1] = *name;
+int tl_intern(LizyLang *lisp, char *name, size_t len, size_t *symbol) {
+    return symbol_intern(&lisp->symbols, name, len, symbol);
+}
+
+/* The call caches only store functions, so they only have to be invalidated
+ * when a function is defined, changed or deleted. */
+
+int tl_add_var(LizyLang *lisp, Var *var, size_t symbol) {
+    Var copy;
+    int rc;
+    rc = var_copy(var, &copy);
+    if(rc) return rc;
+    rc = tl_move_var(lisp, &copy, symbol);
+    if(rc) var_free(&copy);
+    return rc;
+}
+
+/* The variable belongs to the globals if it succeeds, and to the caller
+ * otherwise. */
+int tl_move_var(LizyLang *lisp, Var *var, size_t symbol) {
+    int rc;
+    rc = table_add(&lisp->vars, var, symbol);
+    if(rc) return rc;
+    if(var->type == TL_T_FUNC) lisp->epoch++;
+    var->items = NULL;
+    var->size = 0;
     return TL_SUCCESS;
 }
 
-int tl_set_var(LizyLang *lisp, Var *var, String *name) {
-    size_t i;
-    char found = 0;
+int tl_get_var(LizyLang *lisp, size_t symbol, Var **var) {
+    return table_find(&lisp->vars, symbol, var);
+}
+
+int tl_set_var(LizyLang *lisp, Var *var, size_t symbol) {
+    Var *dest;
     int rc;
+    char pinned;
     if(lisp->stack_cur){
         /* TODO */
     }
-    if(!found){
-        for(i=0;i<lisp->var_num;i++){
-            if(lisp->var_names[i].len != name->len) continue;
-            if(!memcmp(name->data, lisp->var_names[i].data, name->len)){
-                /* Set the variable */
-                if(var->type != lisp->vars[i].type){
-                    return TL_ERR_BAD_TYPE;
-                }
-                rc = var_free(lisp->vars+i);
-                if(rc) return rc;
-                rc = var_copy(var, lisp->vars+i);
-                if(rc) return rc;
-                found = 1;
-                break;
-            }
-        }
-    }
-    if(!found){
-        return TL_ERR_NOT_DEF;
+    rc = table_find(&lisp->vars, symbol, &dest);
+    if(rc) return rc;
+    /* Set the variable, integers and floats are both numbers. */
+    if(var->type != dest->type &&
+       !(VAR_IS_NUMBER(var) && VAR_IS_NUMBER(dest))){
+        return TL_ERR_BAD_TYPE;
     }
-    return TL_SUCCESS;
+    if(dest->type == TL_T_FUNC) lisp->epoch++;
+    table_unpin(&lisp->vars, symbol, &pinned);
+    if(pinned) lisp->fold_epoch++;
+    rc = var_free(dest);
+    if(rc) return rc;
+    return var_copy(var, dest);
 }
 
-int tl_del_var(LizyLang *lisp, String *name) {
-    size_t i;
-    char found = 0;
+int tl_del_var(LizyLang *lisp, size_t symbol) {
+    Var *var;
     int rc;
-    for(i=0;i<lisp->var_num;i++){
-        if(lisp->var_names[i].len != name->len) continue;
-        if(!memcmp(name->data, lisp->var_names[i].data, name->len)){
-            /* Delete the variable */
-            rc = var_free(lisp->vars+i);
-            if(rc) return rc;
-            rc = var_free_str(lisp->var_names+i);
-            if(rc) return rc;
-            if(i < lisp->var_num-1){
-                memmove(lisp->vars+i, lisp->vars+i+1,
-                        sizeof(Var)*lisp->var_num-i-1);
-                memmove(lisp->var_names+i, lisp->var_names+i+1,
-                        sizeof(String)*lisp->var_num-i-1);
-            }
-            lisp->var_num--;
-            found = 1;
-            break;
-        }
-    }
-    if(!found){
-        return TL_ERR_NOT_DEF;
-    }
-    return TL_SUCCESS;
+    char pinned;
+    rc = table_find(&lisp->vars, symbol, &var);
+    if(rc) return rc;
+    if(var->type == TL_T_FUNC) lisp->epoch++;
+    table_unpin(&lisp->vars, symbol, &pinned);
+    if(pinned) lisp->fold_epoch++;
+    return table_remove(&lisp->vars, symbol);
+}
+
+/* The values that were folded are computed again once the variable is
+ * changed or deleted. */
+int tl_pin_var(LizyLang *lisp, size_t symbol) {
+    return table_pin(&lisp->vars, symbol);
 }
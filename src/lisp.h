@@ -48,6 +48,19 @@
  * 2024/10/19: Preparing call-by-need evaluation.
  * 2024/10/20: New stack.
  * 2024/10/21: Perform calls in the right context.
+ * 2026/10/18: Store the global variables in a hash table. Store the context of
+ *             the caller in the stack. Intern the names. Call cache epoch and
+ *             statistics. Store the node and context of each argument in the
+ *             frames. Pending tail call. Growable stack, and arguments of
+ *             the frames stored together. Continuations of the evaluator.
+ *             Bytecode and continuations of the virtual machine.
+ *             Move a variable to the globals. Blocks of the tree.
+ *             Read the code from a callback or a file. Buffer of the
+ *             tokens that are copied. Store the parsed code in a program.
+ *             Compile the code without running it. Epoch of the folded
+ *             values. Buffered output, written by a callback or to a
+ *             file. Buffered input, read from a callback or a file.
+ *             Frames kept for the arguments of tail calls.
  */
 
 #ifndef LISP_H
@@ -56,37 +69,181 @@
 #include <tree.h>
 #include <defs.h>
 #include <var.h>
+#include <table.h>
+#include <symbol.h>
+#include <bytecode.h>
+#include <program.h>
+
+typedef struct {
+    /* Node of the argument and context in which it is evaluated. */
+    Node *node;
+    size_t context;
+    /* Value of the argument, if it was already evaluated. */
+    Var value;
+    char evaluated;
+    /* Bytecode that evaluates it, or TL_NO_CODE. */
+    size_t code;
+} Arg;
+
+typedef struct {
+    Function *function;
+    /* Index of the first argument in the args of the interpreter. */
+    size_t args;
+    size_t argnum;
+    size_t context;
+    /* Frames of the functions it replaced by tail calls, that are kept below
+     * it because its arguments use their parameters. */
+    size_t envs;
+    /* New context of the frame while tail calls remove the unused ones. */
+    size_t kept;
+} Frame;
+
+enum {
+    TL_K_ROOT,
+    TL_K_BUILTIN,
+    TL_K_BODY,
+    TL_K_FORCE,
+    TL_K_VROOT,
+    TL_K_CODE,
+    TL_K_VFORCE
+};
+
+/* What the evaluator does once the node it evaluates has a value:
+ * TL_K_ROOT:    Return it from call_eval.
+ * TL_K_BUILTIN: Store it as the next argument of the builtin of node, and
+ *               call the builtin once the arguments from i are evaluated.
+ * TL_K_BODY:    Run the statement i of the body node of a user function.
+ * TL_K_FORCE:   Store it as the value of the argument base.
+ * The virtual machine uses its own continuations:
+ * TL_K_VROOT:   Return the value from vm_run, and free the values from
+ *               base if there is an error.
+ * TL_K_CODE:    Return from a user function to the code at i.
+ * TL_K_VFORCE:  Store the value of the argument base, and go back to the
+ *               code at i in context. */
+typedef struct {
+    unsigned char type;
+    char tail;
+    Node *node;
+    Function *function;
+    Node **childs;
+    size_t childnum;
+    size_t i;
+    size_t base;
+    size_t context;
+} Cont;
 
 typedef struct {
     char *buffer;
     size_t sz;
-    Var *vars;
-    String *var_names;
-    size_t var_num;
-    struct{
-        Function *function;
-        void *call;
-        Var *args;
-        char *evaluated;
-    }stack[TL_STACK_SZ];
+    /* Reads the code in chunks instead of buffer if it is set. */
+    size_t (*read)(char *buffer, size_t sz, void *data);
+    void *read_data;
+    /* Tokens that contain escape sequences or are split between two chunks
+     * are copied here, the others are used where they are in the code. */
+    char *token;
+    size_t token_max;
+    /* The output is buffered in out, and written by write when it is
+     * full, before reading code or input, and by tl_flush. */
+    char out[TL_WRITE_SZ];
+    size_t out_len;
+    size_t (*write)(char *buffer, size_t sz, void *data);
+    void *write_data;
+    /* The input of the script is read in chunks by input, in is used from
+     * in_pos to in_len, and the lines that are not in one chunk are copied
+     * to in_line. */
+    char in[TL_INPUT_SZ];
+    size_t in_pos;
+    size_t in_len;
+    char in_end;
+    size_t (*input)(char *buffer, size_t sz, void *data);
+    void *input_data;
+    char *in_line;
+    size_t in_line_max;
+    /* Stores the parsed code if it is set. */
+    Program *program;
+    /* Run the statements once they are parsed, tl_compile only stores
+     * them. */
+    char run;
+    Table vars;
+    Symbols symbols;
+    Frame *stack;
     size_t stack_cur;
+    size_t stack_max;
+    size_t max_depth;
+    /* The arguments of all the frames, freed when returning. */
+    Arg *args;
+    size_t args_cur;
+    size_t args_max;
     Call fstack[TL_FSTACK_SZ];
     size_t fstack_cur;
     Var argstack[TL_ARGSTACK_SZ];
     size_t argstack_fnc[TL_ARGSTACK_SZ];
     size_t argstack_cur;
     size_t line;
+    /* Value of the last expression that was run. */
     Var last;
+    /* Root of the tree, its childs are the statements. */
     Node node;
+    Tree tree;
     void *current_node;
     size_t context;
+    size_t epoch;
+    /* The values folded by the optimizer are valid while it is the same,
+     * it changes when a variable they depend on is changed or deleted. */
+    size_t fold_epoch;
+    unsigned long cache_hits;
+    unsigned long cache_misses;
+    /* Continuations of the evaluator, and arguments of the builtins that
+     * are evaluated before calling them. */
+    Cont *conts;
+    size_t conts_cur;
+    size_t conts_max;
+    Var *values;
+    size_t values_cur;
+    size_t values_max;
+    /* Builtin that is called, and index of its first argument in values. */
+    Function *eval_function;
+    Node *eval_node;
+    size_t eval_base;
+    /* A builtin can return the value of a node, or a call to a user defined
+     * function, that the evaluator then evaluates in its place. */
+    Node *next;
+    Node tail_call;
+    Function *tail_function;
+    /* Run the compiled code instead of walking the tree. */
+    Bytecode bc;
+    char bytecode;
 } LizyLang;
 
 int tl_init(LizyLang *lisp, char *buffer, size_t sz);
-int tl_add_var(LizyLang *lisp, Var *var, String *name);
-int tl_set_var(LizyLang *lisp, Var *var, String *name);
-int tl_del_var(LizyLang *lisp, String *name);
+int tl_intern(LizyLang *lisp, char *name, size_t len, size_t *symbol);
+int tl_add_var(LizyLang *lisp, Var *var, size_t symbol);
+int tl_move_var(LizyLang *lisp, Var *var, size_t symbol);
+int tl_get_var(LizyLang *lisp, size_t symbol, Var **var);
+int tl_set_var(LizyLang *lisp, Var *var, size_t symbol);
+int tl_del_var(LizyLang *lisp, size_t symbol);
+int tl_pin_var(LizyLang *lisp, size_t symbol);
+int tl_set_max_depth(LizyLang *lisp, size_t depth);
+int tl_set_bytecode(LizyLang *lisp, char bytecode);
+int tl_set_reader(LizyLang *lisp, size_t read(char*, size_t, void*),
+                  void *data);
+int tl_set_file(LizyLang *lisp, FILE *fp);
+int tl_set_writer(LizyLang *lisp, size_t write(char*, size_t, void*),
+                  void *data);
+int tl_set_output(LizyLang *lisp, FILE *fp);
+int tl_write(LizyLang *lisp, char *data, size_t len);
+int tl_putc(LizyLang *lisp, char c);
+int tl_flush(LizyLang *lisp);
+int tl_set_input_reader(LizyLang *lisp, size_t input(char*, size_t, void*),
+                        void *data);
+int tl_set_input(LizyLang *lisp, FILE *fp);
+int tl_read_line(LizyLang *lisp, Var *line);
+int tl_set_program(LizyLang *lisp, Program *program);
 int tl_run(LizyLang *lisp, void error(char*, void*), void *data);
+int tl_compile(LizyLang *lisp, char *code, size_t sz, Program *program,
+               void error(char*, void*), void *data);
+int tl_exec(LizyLang *lisp, Program *program, void error(char*, void*),
+            void *data);
 int tl_free(LizyLang *lisp);
 
 #endif
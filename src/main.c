@@ -37,6 +37,13 @@
  * 2024/09/28: Started developement. File loading and error handler.
  * 2024/10/12: Avoid segfault if the file isn't found. Error message if the
  *             file isn't found.
+ * 2026/10/18: Print the call cache statistics with -s. Set the maximum call
+ *             depth with -d. Walk the tree instead of running the
+ *             bytecode with -t. Read the code from the standard input
+ *             with -. Map the file in memory instead of copying it. Run
+ *             the program saved in the .lzyc file if it is up to date,
+ *             and save it otherwise, unless -n is passed. stdout is not
+ *             buffered, as the interpreter buffers its output.
  */
 
 #include <lisp.h>
@@ -51,35 +58,106 @@ void onerror(char *message, void *data) {
     fprintf(stderr, "%s:%ld: Error: %s\n", file, lisp->line, message);
 }
 
+int save_program(FILE *fp, void *data) {
+    LizyLang *lisp = data;
+    int rc;
+    rc = program_set_symbols(lisp->program, &lisp->symbols);
+    if(rc) return rc;
+    return program_save(lisp->program, lisp->buffer, lisp->sz, fp);
+}
+
+/* The parsed code is saved in the file with a c added to its name, and
+ * loaded from there the next times if the code did not change. */
+int run_cached(LizyLang *lisp, Source *source) {
+    Source saved;
+    Program program;
+    char *path;
+    int rc;
+    path = malloc(strlen(file)+2);
+    if(!path) return tl_run(lisp, onerror, lisp);
+    strcpy(path, file);
+    strcat(path, "c");
+    if(!platform_load(path, &saved)){
+        if(!program_check(saved.data, saved.sz, source->data, source->sz,
+                          &program)){
+            rc = tl_exec(lisp, &program, onerror, lisp);
+            platform_unload(&saved);
+            free(path);
+            return rc;
+        }
+        platform_unload(&saved);
+    }
+    program_init(&program);
+    tl_set_program(lisp, &program);
+    rc = tl_run(lisp, onerror, lisp);
+    /* The program is not saved if the code could not be run completely,
+     * or if the file can not be written. */
+    if(!rc) platform_save(path, save_program, lisp);
+    tl_set_program(lisp, NULL);
+    program_free(&program);
+    free(path);
+    return rc;
+}
+
 int main(int argc, char **argv) {
-    FILE *fp;
+    Source source;
     LizyLang lisp;
-    size_t sz;
-    char *buffer;
     int rc;
-    if(argc < 2){
-        fputs("USAGE: lizylang [INPUT]\n", stderr);
+    int arg = 1;
+    char stats = 0;
+    char cache = 1;
+    char bytecode = 1;
+    size_t depth = TL_STACK_SZ;
+    while(argc > arg+1 && argv[arg][0] == '-'){
+        if(!strcmp(argv[arg], "-s")){
+            stats = 1;
+        }else if(!strcmp(argv[arg], "-t")){
+            bytecode = 0;
+        }else if(!strcmp(argv[arg], "-n")){
+            cache = 0;
+        }else if(!strcmp(argv[arg], "-d")){
+            arg++;
+            depth = strtoul(argv[arg], NULL, 10);
+        }else{
+            break;
+        }
+        arg++;
+    }
+    if(argc <= arg || !depth){
+        fputs("USAGE: lizylang [-s] [-t] [-n] [-d DEPTH] [INPUT]\n"
+              "INPUT is - to read the code from the standard input.\n"
+              "-n does not load or save the parsed code in INPUTc.\n",
+              stderr);
         return EXIT_FAILURE;
     }
-    file = argv[1];
-    fp = fopen(argv[1], "r");
-    if(!fp){
+    file = argv[arg];
+    source.data = NULL;
+    source.sz = 0;
+    source.mapped = 0;
+    if(strcmp(file, "-") && platform_load(file, &source)){
         fprintf(stderr, "[lizylang] File not found!\n");
         return EXIT_FAILURE;
     }
-    fseek(fp, 0L, SEEK_END);
-    sz = ftell(fp);
-    rewind(fp);
-    buffer = malloc(sz*sizeof(char));
-    if(!buffer){
-        fprintf(stderr, "[lizylang] Failed to allocate code buffer!\n");
-        return EXIT_FAILURE;
+    /* The output is written in chunks of TL_WRITE_SZ by the interpreter. */
+    setvbuf(stdout, NULL, _IONBF, 0);
+    tl_init(&lisp, source.data, source.sz);
+    tl_set_max_depth(&lisp, depth);
+    tl_set_bytecode(&lisp, bytecode);
+    if(!strcmp(file, "-")){
+        /* Each statement runs as soon as it is read. */
+        file = "stdin";
+        tl_set_file(&lisp, stdin);
+        rc = tl_run(&lisp, onerror, &lisp);
+    }else if(cache){
+        rc = run_cached(&lisp, &source);
+    }else{
+        rc = tl_run(&lisp, onerror, &lisp);
+    }
+    if(stats){
+        fprintf(stderr, "[lizylang] Call cache: %lu hits, %lu misses\n",
+                lisp.cache_hits, lisp.cache_misses);
     }
-    fread(buffer, 1, sz, fp);
-    fclose(fp);
-    tl_init(&lisp, buffer, sz);
-    rc = tl_run(&lisp, onerror, &lisp);
     tl_free(&lisp);
-    free(buffer);
+    platform_unload(&source);
     return rc;
 }
@@ -0,0 +1,457 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Shortest strings of the numbers, that
+ *             are parsed back to the same numbers. Modulo with the
+ *             sign of the dividend. Sign of -0.0.
+ */
+
+#include <number.h>
+
+/* Writes the digits of an integer and returns their length. */
+size_t number_digits(char *str, unsigned long mag) {
+    char digits[sizeof(long)*3];
+    size_t len = 0;
+    size_t n = 0;
+    do{
+        digits[n++] = '0'+mag%10;
+        mag /= 10;
+    }while(mag);
+    while(n) str[len++] = digits[--n];
+    str[len] = '\0';
+    return len;
+}
+
+#ifdef TL_FIXED
+
+#define NUMBER_BITS (sizeof(TL_FLOAT)*CHAR_BIT)
+#define NUMBER_HALF (NUMBER_BITS/2)
+#define NUMBER_LOW  (((unsigned TL_FIXED_T)1<<NUMBER_HALF)-1)
+#define NUMBER_FRAC ((unsigned TL_FIXED_T)NUMBER_ONE-1)
+
+/* The fixed point numbers that do not fit are saturated, like floats
+ * become infinite. */
+#define NUMBER_SATURATE(negative) ((negative) ? -TL_FIXED_MAX : TL_FIXED_MAX)
+
+/* Magnitude of a number, that fits even for TL_FIXED_MIN. */
+#define NUMBER_ABS(num) ((num) < 0 ? -(unsigned TL_FIXED_T)(num) : \
+                         (unsigned TL_FIXED_T)(num))
+
+/* Number with the sign of negative and the magnitude mag, that is at most
+ * TL_FIXED_MAX. */
+TL_FLOAT number_signed(unsigned TL_FIXED_T mag, char negative) {
+    return negative ? -(TL_FLOAT)mag : (TL_FLOAT)mag;
+}
+
+/* The integer is compared as an unsigned long, as TL_INT can be smaller or
+ * bigger than TL_FIXED_T. */
+TL_FLOAT number_from_int(TL_INT integer) {
+    unsigned long mag = integer < 0 ? -(unsigned long)integer :
+                        (unsigned long)integer;
+    if(mag > (unsigned long)(TL_FIXED_MAX>>TL_FIXED)){
+        return NUMBER_SATURATE(integer < 0);
+    }
+    return (TL_FLOAT)integer*NUMBER_ONE;
+}
+
+TL_FLOAT number_add(TL_FLOAT a, TL_FLOAT b) {
+    if(b > 0 ? a > TL_FIXED_MAX-b : a < TL_FIXED_MIN-b){
+        return NUMBER_SATURATE(b < 0);
+    }
+    return a+b;
+}
+
+TL_FLOAT number_sub(TL_FLOAT a, TL_FLOAT b) {
+    if(b < 0 ? a > TL_FIXED_MAX+b : a < TL_FIXED_MIN+b){
+        return NUMBER_SATURATE(b > 0);
+    }
+    return a-b;
+}
+
+/* The product has twice as many bits as the numbers, so it is computed
+ * from their halves, and then rounded to the nearest number. */
+TL_FLOAT number_mul(TL_FLOAT a, TL_FLOAT b) {
+    unsigned TL_FIXED_T x = NUMBER_ABS(a);
+    unsigned TL_FIXED_T y = NUMBER_ABS(b);
+    unsigned TL_FIXED_T low, mid, cross, high, mag;
+    char negative = (a < 0) != (b < 0);
+    low = (x&NUMBER_LOW)*(y&NUMBER_LOW);
+    cross = (x&NUMBER_LOW)*(y>>NUMBER_HALF);
+    mid = (x>>NUMBER_HALF)*(y&NUMBER_LOW);
+    high = (x>>NUMBER_HALF)*(y>>NUMBER_HALF)+(cross>>NUMBER_HALF)+
+           (mid>>NUMBER_HALF);
+    mid = (low>>NUMBER_HALF)+(cross&NUMBER_LOW)+(mid&NUMBER_LOW);
+    high += mid>>NUMBER_HALF;
+    low = (low&NUMBER_LOW)|(mid<<NUMBER_HALF);
+    if(high>>TL_FIXED) return NUMBER_SATURATE(negative);
+    mag = (low>>TL_FIXED)|(high<<(NUMBER_BITS-TL_FIXED));
+    if(mag > TL_FIXED_MAX) return NUMBER_SATURATE(negative);
+    mag += (low>>(TL_FIXED-1))&1;
+    if(mag > TL_FIXED_MAX) return NUMBER_SATURATE(negative);
+    return number_signed(mag, negative);
+}
+
+/* The remainder has the sign of a, like fmod. % leaves it to the compiler
+ * with negative operands in C89, so it is computed on the magnitudes. b is
+ * not 0. */
+TL_FLOAT number_mod(TL_FLOAT a, TL_FLOAT b) {
+    return number_signed(NUMBER_ABS(a)%NUMBER_ABS(b), a < 0);
+}
+
+/* The integer part of the quotient is computed first, and then one bit
+ * after the point at a time from the remainder. b is not 0. */
+TL_FLOAT number_div(TL_FLOAT a, TL_FLOAT b) {
+    unsigned TL_FIXED_T x = NUMBER_ABS(a);
+    unsigned TL_FIXED_T y = NUMBER_ABS(b);
+    unsigned TL_FIXED_T mag = x/y;
+    unsigned TL_FIXED_T rem = x%y;
+    char negative = (a < 0) != (b < 0);
+    size_t i;
+    if(mag > TL_FIXED_MAX>>TL_FIXED) return NUMBER_SATURATE(negative);
+    for(i=0;i<TL_FIXED;i++){
+        rem <<= 1;
+        mag <<= 1;
+        if(rem >= y){
+            rem -= y;
+            mag |= 1;
+        }
+    }
+    if(rem >= y-rem) mag++;
+    if(mag > TL_FIXED_MAX) return NUMBER_SATURATE(negative);
+    return number_signed(mag, negative);
+}
+
+TL_FLOAT number_floor(TL_FLOAT num) {
+    TL_FLOAT whole = num/NUMBER_ONE*NUMBER_ONE;
+    if(whole <= num) return whole;
+    return number_sub(whole, NUMBER_ONE);
+}
+
+TL_FLOAT number_ceil(TL_FLOAT num) {
+    TL_FLOAT whole = num/NUMBER_ONE*NUMBER_ONE;
+    if(whole >= num) return whole;
+    return number_add(whole, NUMBER_ONE);
+}
+
+/* Bits after the point of the n decimals in data, rounded to the nearest
+ * and to an even number on ties. The decimals are doubled TL_FIXED times,
+ * and the digit that goes past the point each time is the next bit. The
+ * ones after the TL_FIXED+1 first ones can only break a tie. */
+unsigned TL_FIXED_T number_fraction(char *data, size_t n) {
+    char digits[TL_FIXED+1];
+    unsigned TL_FIXED_T frac = 0;
+    size_t len = n > TL_FIXED+1 ? TL_FIXED+1 : n;
+    size_t i, j;
+    char carry, rest = 0;
+    for(i=len;i<n;i++) rest |= data[i] != '0';
+    for(i=0;i<len;i++) digits[i] = data[i]-'0';
+    for(i=0;i<=TL_FIXED;i++){
+        carry = 0;
+        for(j=len;j-->0;){
+            digits[j] = digits[j]*2+carry;
+            carry = digits[j] >= 10;
+            if(carry) digits[j] -= 10;
+        }
+        if(i < TL_FIXED) frac = frac<<1|carry;
+    }
+    /* The last carry is set if the rest is at least one half. */
+    for(i=0;i<len;i++) rest |= digits[i];
+    if(carry && (rest || frac&1)) frac++;
+    return frac;
+}
+
+int number_parse(TL_FLOAT *num, char *data, size_t len) {
+    unsigned TL_FIXED_T whole = 0;
+    char negative = 0;
+    size_t dot;
+    char c;
+    if(len && data[0] == '-'){
+        negative = 1;
+        data++;
+        len--;
+    }
+    for(dot=0;dot<len&&data[dot]!='.';dot++){
+        c = data[dot]-'0';
+        if(whole > (unsigned TL_FIXED_T)((TL_FIXED_MAX>>TL_FIXED)-c)/10){
+            *num = NUMBER_SATURATE(negative);
+            return TL_SUCCESS;
+        }
+        whole = whole*10+c;
+    }
+    whole <<= TL_FIXED;
+    if(dot < len) whole += number_fraction(data+dot+1, len-dot-1);
+    *num = whole > TL_FIXED_MAX ? NUMBER_SATURATE(negative) :
+           number_signed(whole, negative);
+    return TL_SUCCESS;
+}
+
+/* Writes the fewest decimals that number_parse reads back as num, at most
+ * TL_FIXED that are then exact, and returns the length of the string. */
+size_t number_str(char *str, TL_FLOAT num) {
+    unsigned TL_FIXED_T mag = NUMBER_ABS(num);
+    unsigned TL_FIXED_T whole, frac;
+    char decimals[TL_FIXED];
+    size_t len = 0;
+    size_t i, n;
+    for(n=1;;n++){
+        whole = mag>>TL_FIXED;
+        frac = mag&NUMBER_FRAC;
+        for(i=0;i<n;i++){
+            frac *= 10;
+            decimals[i] = '0'+(frac>>TL_FIXED);
+            frac &= NUMBER_FRAC;
+        }
+        if(n == TL_FIXED) break;
+        if(frac > NUMBER_ONE/2 || (frac == NUMBER_ONE/2 && decimals[n-1]&1)){
+            for(i=n;i-->0&&decimals[i]=='9';) decimals[i] = '0';
+            if(i < n) decimals[i]++;
+            else whole++;
+        }
+        if((whole<<TL_FIXED)+number_fraction(decimals, n) == mag) break;
+    }
+    if(num < 0) str[len++] = '-';
+    len += number_digits(str+len, whole);
+    str[len++] = '.';
+    for(i=0;i<n;i++) str[len++] = decimals[i];
+    str[len] = '\0';
+    return len;
+}
+
+#else
+
+/* The digits are computed with doubles, that hold integers of up to
+ * NUMBER_DIGITS digits exactly. A double can need more of them, or a power
+ * of ten that is not exact, and is then converted by the C library. */
+#ifdef TL_DOUBLE
+#define NUMBER_MAX    DBL_MAX
+#define NUMBER_DIGITS DBL_DIG
+#else
+#define NUMBER_MAX    FLT_MAX
+#define NUMBER_DIGITS (FLT_DIG+3)
+#endif
+
+/* Powers of ten that are exact doubles. */
+static const double number_tens[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Value of the integer m times 10^k. It is rounded once if the power of
+ * ten is exact, and computed in the same way by number_parse and
+ * number_str, so that the numbers written by number_str are read back as
+ * the same ones. */
+double number_decimal(double m, int k) {
+    double ten = 1;
+    int n = k < 0 ? -k : k;
+    for(;n>22;n-=22) ten *= 1e22;
+    ten *= number_tens[n];
+    return k < 0 ? m/ten : m*ten;
+}
+
+#ifdef TL_DOUBLE
+/* Reads a number that is not exact with number_decimal with strtod. */
+int number_parse_long(TL_FLOAT *num, char *data, size_t len) {
+    char *str = malloc(len+1);
+    if(!str) return TL_ERR_OUT_OF_MEM;
+    memcpy(str, data, len);
+    str[len] = '\0';
+    *num = strtod(str, NULL);
+    free(str);
+    return TL_SUCCESS;
+}
+#endif
+
+/* The digits without the trailing zeros are read as an integer, and the
+ * zeros change the power of ten it is multiplied by. */
+int number_parse(TL_FLOAT *num, char *data, size_t len) {
+    double m = 0;
+    int k = 0;
+    int zeros = 0;
+    int digits = 0;
+    char negative = 0;
+    char dot = 0;
+    size_t i;
+    if(len && data[0] == '-') negative = 1;
+    for(i=negative;i<len;i++){
+        if(data[i] == '.'){
+            dot = 1;
+            continue;
+        }
+        k -= dot;
+        if(data[i] == '0'){
+            zeros++;
+            continue;
+        }
+        digits = m ? digits+zeros+1 : 1;
+        m = number_decimal(m, zeros+1)+(data[i]-'0');
+        zeros = 0;
+    }
+    k += zeros;
+#ifdef TL_DOUBLE
+    if(digits > NUMBER_DIGITS || k < -22 || k > 22){
+        return number_parse_long(num, data, len);
+    }
+#endif
+    m = number_decimal(m, k);
+    *num = (TL_FLOAT)(negative ? -m : m);
+    return TL_SUCCESS;
+}
+
+/* Rounds x to the integer m times 10^k of p digits, the first of them at
+ * 10^e, without its trailing zeros, and tells whether number_parse reads
+ * it back as x. */
+int number_round(double x, int e, int p, double *m, int *k) {
+    *k = e-p+1;
+    *m = floor(number_decimal(x, -*k)+0.5);
+    while(floor(*m/10)*10 == *m){
+        *m /= 10;
+        ++*k;
+    }
+    return (TL_FLOAT)number_decimal(*m, *k) == (TL_FLOAT)x;
+}
+
+/* Gets the fewest digits that number_parse reads back as x, and the power
+ * of ten of the first one, or 0 if number_parse reads them with strtod. */
+size_t number_shortest(double x, char *digits, int *e) {
+    char reversed[NUMBER_DIGITS];
+    double m, d;
+    size_t n = 0;
+    int lo = 1, hi = NUMBER_DIGITS;
+    int k, p;
+    *e = (int)floor(log10(x));
+    if(number_decimal(1, *e) > x) --*e;
+    else if(number_decimal(1, *e+1) <= x) ++*e;
+#ifdef TL_DOUBLE
+    if(*e > 22 || *e-NUMBER_DIGITS+1 < -22) return 0;
+    if(!number_round(x, *e, hi, &m, &k)) return 0;
+#endif
+    /* More digits are closer to x, so the fewest are searched by halves. */
+    while(lo < hi){
+        p = (lo+hi)/2;
+        if(number_round(x, *e, p, &d, &k)) hi = p;
+        else lo = p+1;
+    }
+    number_round(x, *e, lo, &m, &k);
+    do{
+        d = floor(m/10);
+        reversed[n++] = '0'+(int)(m-d*10);
+        m = d;
+    }while(m >= 1 && n < NUMBER_DIGITS);
+    *e = k+(int)n-1;
+    for(p=0;p<(int)n;p++) digits[p] = reversed[n-p-1];
+    return n;
+}
+
+#ifdef TL_DOUBLE
+/* The digits of the other doubles are written by sprintf, that is tried
+ * from one of them up to the 17 that identify any double. */
+size_t number_longest(double x, char *digits, int *e) {
+    char str[DBL_DIG+3+8];
+    size_t n = 0;
+    int p;
+    char *c;
+    for(p=0;p<=DBL_DIG+1;p++){
+        sprintf(str, "%.*e", p, x);
+        if(strtod(str, NULL) == x) break;
+    }
+    for(c=str;*c!='e';c++){
+        if(*c >= '0' && *c <= '9') digits[n++] = *c;
+    }
+    *e = atoi(c+1);
+    while(n > 1 && digits[n-1] == '0') n--;
+    return n;
+}
+#endif
+
+/* Writes the fewest digits that number_parse reads back as num, without an
+ * exponent and with at least one decimal, and returns the length of the
+ * string. */
+size_t number_str(char *str, TL_FLOAT num) {
+    double x = num < 0 ? -(double)num : num;
+    char digits[DBL_DIG+2];
+    size_t len = 0;
+    size_t i, n;
+    int e;
+    if(num != num){
+        strcpy(str, "nan");
+        return 3;
+    }
+    /* C89 has no signbit, the sign of -0.0 is found by dividing by it. */
+    if(num < 0 || (num == 0 && 1/num < 0)) str[len++] = '-';
+    if(x > NUMBER_MAX){
+        strcpy(str+len, "inf");
+        return len+3;
+    }
+    if(x == 0){
+        strcpy(str+len, "0.0");
+        return len+3;
+    }
+    n = number_shortest(x, digits, &e);
+#ifdef TL_DOUBLE
+    if(!n) n = number_longest(x, digits, &e);
+#endif
+    /* The first digit is at 10^e. */
+    if(e < 0){
+        str[len++] = '0';
+        str[len++] = '.';
+        for(;++e<0;) str[len++] = '0';
+        for(i=0;i<n;i++) str[len++] = digits[i];
+    }else{
+        for(i=0;(int)i<=e;i++) str[len++] = i < n ? digits[i] : '0';
+        str[len++] = '.';
+        if(i >= n) str[len++] = '0';
+        for(;i<n;i++) str[len++] = digits[i];
+    }
+    str[len] = '\0';
+    return len;
+}
+
+#endif
+
+size_t number_int_str(char *str, TL_INT integer) {
+    if(integer < 0){
+        *str = '-';
+        return number_digits(str+1, -(unsigned long)integer)+1;
+    }
+    return number_digits(str, integer);
+}
+
+/* Same as number_mod for the integers. */
+TL_INT number_int_mod(TL_INT a, TL_INT b) {
+    unsigned long x = a < 0 ? -(unsigned long)a : (unsigned long)a;
+    unsigned long y = b < 0 ? -(unsigned long)b : (unsigned long)b;
+    return a < 0 ? -(TL_INT)(x%y) : (TL_INT)(x%y);
+}
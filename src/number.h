@@ -0,0 +1,98 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Shortest strings of the numbers. Modulo
+ *             with the sign of the dividend.
+ */
+
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <defs.h>
+
+/* Operations on the numbers that are not integers, that are done by the
+ * FPU or, if TL_FIXED is defined, on fixed point numbers. NUMBER_STR_SZ is
+ * the size of the string of any number, with its nul terminator. */
+#ifdef TL_FIXED
+#define NUMBER_ONE           ((TL_FLOAT)1<<TL_FIXED)
+#define NUMBER_STR_SZ        (sizeof(TL_FLOAT)*3+sizeof(TL_INT)*3+ \
+                              TL_FIXED+3)
+#define NUMBER_FROM_INT(i)   number_from_int(i)
+#define NUMBER_TO_INT(num)   ((TL_INT)((num)/NUMBER_ONE))
+#define NUMBER_FITS_INT(num) (NUMBER_TO_INT(num) == (num)/NUMBER_ONE)
+#define NUMBER_ADD(a, b)     number_add(a, b)
+#define NUMBER_SUB(a, b)     number_sub(a, b)
+#define NUMBER_MUL(a, b)     number_mul(a, b)
+#define NUMBER_DIV(a, b)     number_div(a, b)
+#define NUMBER_MOD(a, b)     number_mod(a, b)
+#define NUMBER_FLOOR(num)    number_floor(num)
+#define NUMBER_CEIL(num)     number_ceil(num)
+#else
+#ifdef TL_DOUBLE
+#define NUMBER_STR_SZ        (DBL_MAX_10_EXP-DBL_MIN_10_EXP+20)
+#else
+#define NUMBER_STR_SZ        (FLT_MAX_10_EXP-FLT_MIN_10_EXP+20)
+#endif
+#define NUMBER_FROM_INT(i)   ((TL_FLOAT)(i))
+#define NUMBER_TO_INT(num)   ((TL_INT)(num))
+#define NUMBER_FITS_INT(num) ((num) > (TL_FLOAT)TL_INT_MIN && \
+                              (num) < -(TL_FLOAT)TL_INT_MIN)
+#define NUMBER_ADD(a, b)     ((a)+(b))
+#define NUMBER_SUB(a, b)     ((a)-(b))
+#define NUMBER_MUL(a, b)     ((a)*(b))
+#define NUMBER_DIV(a, b)     ((a)/(b))
+#define NUMBER_MOD(a, b)     ((TL_FLOAT)fmod(a, b))
+#define NUMBER_FLOOR(num)    ((TL_FLOAT)floor(num))
+#define NUMBER_CEIL(num)     ((TL_FLOAT)ceil(num))
+#endif
+
+int number_parse(TL_FLOAT *num, char *data, size_t len);
+size_t number_str(char *str, TL_FLOAT num);
+size_t number_int_str(char *str, TL_INT integer);
+TL_INT number_int_mod(TL_INT a, TL_INT b);
+
+#ifdef TL_FIXED
+TL_FLOAT number_from_int(TL_INT integer);
+TL_FLOAT number_add(TL_FLOAT a, TL_FLOAT b);
+TL_FLOAT number_sub(TL_FLOAT a, TL_FLOAT b);
+TL_FLOAT number_mul(TL_FLOAT a, TL_FLOAT b);
+TL_FLOAT number_div(TL_FLOAT a, TL_FLOAT b);
+TL_FLOAT number_mod(TL_FLOAT a, TL_FLOAT b);
+TL_FLOAT number_floor(TL_FLOAT num);
+TL_FLOAT number_ceil(TL_FLOAT num);
+#endif
+
+#endif
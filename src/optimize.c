@@ -0,0 +1,193 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. The calls nested too deeply are not
+ *             folded.
+ */
+
+#include <optimize.h>
+#include <call.h>
+#include <builtin.h>
+
+/* Builtins that only compute their value from their arguments. */
+int (*optimize_pure[])(void *lisp, void *node, size_t argnum,
+                       void *returned) = {
+    builtin_comment,
+    builtin_add,
+    builtin_substract,
+    builtin_multiply,
+    builtin_divide,
+    builtin_modulo,
+    builtin_smaller,
+    builtin_bigger,
+    builtin_smaller_or_equal,
+    builtin_bigger_or_equal,
+    builtin_equal,
+    builtin_not_equal,
+    builtin_floor,
+    builtin_ceil,
+    builtin_strlen,
+    builtin_strget,
+    builtin_parsenum,
+    builtin_numstr,
+    NULL
+};
+
+/* Folds the calls of the body of a function, once its parameters are
+ * resolved: the names that are not parameters are then globals. */
+int optimize_body(LizyLang *lisp, Node *fncdef) {
+    size_t i;
+    int rc;
+    char constant;
+    for(i=2;i<fncdef->childnum;i++){
+        rc = optimize_node(lisp, ((Node**)fncdef->childs)[i], 0, &constant);
+        if(rc) return rc;
+    }
+    return TL_SUCCESS;
+}
+
+char optimize_is_pure(Function *function) {
+    size_t i;
+    if(!function->builtin) return 0;
+    for(i=0;optimize_pure[i];i++){
+        if(function->ptr.f == optimize_pure[i]) return 1;
+    }
+    return 0;
+}
+
+/* constant is set if the value of the node is known: it is a number or a
+ * string, a global that contains one, or a call that was folded. The
+ * nodes deeper than TL_FOLD_DEPTH are left to the evaluator, so that the
+ * recursion stays small. */
+int optimize_node(LizyLang *lisp, Node *node, size_t depth, char *constant) {
+    Function *function = NULL;
+    Node **childs = node->childs;
+    Var *var;
+    size_t i, symbol;
+    int rc;
+    char all = 1;
+    char child;
+    *constant = 0;
+    if(node->is_param || depth >= TL_FOLD_DEPTH) return TL_SUCCESS;
+    if(node->var->type == TL_T_NAME){
+        if(VAR_LEN(node->var) != 1) return TL_SUCCESS;
+        if(tl_get_var(lisp, VAR_ITEMS(node->var)->symbol, &var)){
+            return TL_SUCCESS;
+        }
+        *constant = VAR_IS_NUMBER(var) || var->type == TL_T_STR;
+        return TL_SUCCESS;
+    }
+    if(node->var->type != TL_T_CALL){
+        *constant = VAR_IS_NUMBER(node->var) ||
+                    node->var->type == TL_T_STR;
+        return TL_SUCCESS;
+    }
+    if(OPTIMIZE_FOLDED(lisp, node)){
+        /* It was folded when the function was defined before. */
+        *constant = 1;
+        return TL_SUCCESS;
+    }
+    if(VAR_LEN(node->var) != 1 || !node->var->items->call.has_func){
+        return TL_SUCCESS;
+    }
+    symbol = node->var->items->call.function;
+    if(!tl_get_var(lisp, symbol, &var) && var->type == TL_T_FUNC){
+        function = &var->items->function;
+        if(function->builtin && function->ptr.f == builtin_comment){
+            return optimize_fold(lisp, node, function, constant);
+        }
+        /* The raw arguments are not evaluated, and the ones of fncdef are
+         * resolved when it runs. */
+        if(function->builtin && function->eval == TL_ARGS_RAW){
+            return TL_SUCCESS;
+        }
+        /* The childs are folded as arguments of this function, that must
+         * stay the same. */
+        rc = tl_pin_var(lisp, symbol);
+        if(rc) return rc;
+    }
+    for(i=0;i<node->childnum;i++){
+        rc = optimize_node(lisp, childs[i], depth+1, &child);
+        if(rc) return rc;
+        if(!child) all = 0;
+    }
+    if(!all || !function || !optimize_is_pure(function)) return TL_SUCCESS;
+    return optimize_fold(lisp, node, function, constant);
+}
+
+/* Computes the value of the call, that is then used in its place until
+ * the function or one of the globals it is called with changes. */
+int optimize_fold(LizyLang *lisp, Node *node, Function *function,
+                  char *folded) {
+    Node **childs = node->childs;
+    Var value;
+    size_t i;
+    int rc;
+    *folded = 0;
+    /* If it fails, it is reported when it is run. */
+    if(call_exec(lisp, node, &value)) return TL_SUCCESS;
+    if(!VAR_IS_NUMBER(&value) && value.type != TL_T_STR){
+        var_free(&value);
+        return TL_SUCCESS;
+    }
+    rc = tl_pin_var(lisp, node->var->items->call.function);
+    for(i=0;i<node->childnum && !rc;i++){
+        if(function->eval == TL_ARGS_RAW) break;
+        if(childs[i]->var->type != TL_T_NAME) continue;
+        rc = tl_pin_var(lisp, VAR_ITEMS(childs[i]->var)->symbol);
+    }
+    if(rc){
+        var_free(&value);
+        return rc;
+    }
+    /* It is stored with the values of the tree, and replaced if it is
+     * folded again. */
+    if(node->folded){
+        var_free(node->folded);
+    }else{
+        rc = tree_alloc(&lisp->tree.values, sizeof(Var),
+                        (void**)&node->folded);
+        if(rc){
+            var_free(&value);
+            return rc;
+        }
+    }
+    var_move(&value, node->folded);
+    node->fold_epoch = lisp->fold_epoch;
+    *folded = 1;
+    return TL_SUCCESS;
+}
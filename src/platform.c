@@ -35,6 +35,132 @@
 /* CHANGELOG
  *
  * 2024/09/28: Started developement.
+ * 2026/10/18: Load the code of a file, mapping it in memory when it is
+ *             possible. Save a file without leaving it partially written.
  */
 
+/* mmap and madvise are not a part of ANSI C. */
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include <platform.h>
+#include <defs.h>
+
+#if TL_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if TL_POSIX
+/* Returns 1 if the file was mapped, and 0 if it has to be read. */
+char platform_map(char *path, Source *source) {
+    struct stat info;
+    int fd;
+    int flags = MAP_PRIVATE;
+    void *data;
+    fd = open(path, O_RDONLY);
+    if(fd < 0) return 0;
+    /* Pipes and devices can not be mapped. */
+    if(fstat(fd, &info) || !S_ISREG(info.st_mode)){
+        close(fd);
+        return 0;
+    }
+    source->sz = info.st_size;
+    source->data = NULL;
+    source->mapped = 0;
+    if(!source->sz){
+        close(fd);
+        return 1;
+    }
+#ifdef MAP_POPULATE
+    /* The whole file is parsed, so it can be read at once. */
+    flags |= MAP_POPULATE;
+#endif
+    data = mmap(NULL, source->sz, PROT_READ, flags, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) return 0;
+#ifdef MADV_SEQUENTIAL
+    madvise(data, source->sz, MADV_SEQUENTIAL);
+#endif
+    source->data = data;
+    source->mapped = 1;
+    return 1;
+}
+#endif
+
+/* The code is read only, and stays valid until platform_unload. */
+int platform_load(char *path, Source *source) {
+    FILE *fp;
+    long sz;
+#if TL_POSIX
+    if(platform_map(path, source)) return TL_SUCCESS;
+#endif
+    source->data = NULL;
+    source->sz = 0;
+    source->mapped = 0;
+    fp = fopen(path, "rb");
+    if(!fp) return TL_ERR_BAD_INPUT;
+    if(fseek(fp, 0, SEEK_END) || (sz = ftell(fp)) < 0 ||
+       fseek(fp, 0, SEEK_SET)){
+        fclose(fp);
+        return TL_ERR_BAD_INPUT;
+    }
+    source->data = malloc(sz ? sz : 1);
+    if(!source->data){
+        fclose(fp);
+        return TL_ERR_OUT_OF_MEM;
+    }
+    source->sz = fread(source->data, 1, sz, fp);
+    fclose(fp);
+    return TL_SUCCESS;
+}
+
+int platform_unload(Source *source) {
+#if TL_POSIX
+    if(source->mapped){
+        munmap(source->data, source->sz);
+        source->data = NULL;
+        source->sz = 0;
+        source->mapped = 0;
+        return TL_SUCCESS;
+    }
+#endif
+    free(source->data);
+    source->data = NULL;
+    source->sz = 0;
+    return TL_SUCCESS;
+}
+
+/* Writes the file at path with save, in a temporary file that replaces it
+ * once it was written completely. */
+int platform_save(char *path, int save(FILE *fp, void *data), void *data) {
+    char *tmp;
+    FILE *fp;
+    int rc;
+    /* Programs that save the same file at the same time each use their own
+     * temporary file. */
+    tmp = malloc(strlen(path)+32);
+    if(!tmp) return TL_ERR_OUT_OF_MEM;
+#if TL_POSIX
+    sprintf(tmp, "%s.%ld", path, (long)getpid());
+#else
+    sprintf(tmp, "%s.tmp", path);
+#endif
+    fp = fopen(tmp, "wb");
+    if(!fp){
+        free(tmp);
+        return TL_ERR_BAD_INPUT;
+    }
+    rc = save(fp, data);
+    if(fclose(fp) && !rc) rc = TL_ERR_BAD_INPUT;
+#if !TL_POSIX
+    if(!rc) remove(path);
+#endif
+    if(!rc && rename(tmp, path)) rc = TL_ERR_BAD_INPUT;
+    if(rc) remove(tmp);
+    free(tmp);
+    return rc;
+}
@@ -40,6 +40,9 @@
  * 2024/10/04: Debug function searching.
  * 2024/10/15: Debug the tree generation.
  * 2024/10/21: Debug the context.
+ * 2026/10/18: Disabled call and context debugging. Load the code of a file,
+ *             mapping it in memory when it is possible. Save a file.
+ *             Limits of the integers and of the floats.
  */
 
 #ifndef PLATFORM_H
@@ -49,6 +52,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <float.h>
 #include <mcheck.h>
 
 /*
@@ -63,11 +68,30 @@
 #define TL_DEBUG_ARGSTACK 0
 #define TL_DEBUG_FSTACK   0
 #define TL_DEBUG_TOKENS   0
-#define TL_DEBUG_CALL     1
+#define TL_DEBUG_CALL     0
 #define TL_DEBUG_VARS     0
 #define TL_DEBUG_TREE     0
 #define TL_DEBUG_STACK    0
-#define TL_DEBUG_CONTEXT  1
+#define TL_DEBUG_CONTEXT  0
 #define TL_LEAK_CHECK     1
 
+/* POSIX systems, where the files that are loaded are mapped in memory
+ * instead of being read. */
+#if defined(__unix__) || defined(__APPLE__)
+#define TL_POSIX          1
+#else
+#define TL_POSIX          0
+#endif
+
+/* Code of a file loaded by platform_load. */
+typedef struct {
+    char *data;
+    size_t sz;
+    char mapped;
+} Source;
+
+int platform_load(char *path, Source *source);
+int platform_unload(Source *source);
+int platform_save(char *path, int save(FILE *fp, void *data), void *data);
+
 #endif
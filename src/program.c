@@ -0,0 +1,385 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Programs store the names of their
+ *             symbols, and can be views of a saved program. Integers.
+ *             Floats of any type. Check all the events of a program
+ *             before running it.
+ */
+
+#include <program.h>
+
+/* The numbers are stored 7 bits at a time, starting with the lowest ones.
+ * The highest bit of a byte is set if more of them follow. */
+
+/* Stores num in data, that has room for at least TL_NUM_MAX bytes, and
+ * returns how many bytes it took. */
+#define TL_NUM_MAX (sizeof(size_t)*8/7+1)
+
+size_t program_encode(unsigned char *data, size_t num) {
+    size_t len = 0;
+    while(num >= 0x80){
+        data[len++] = (unsigned char)(num&0x7F)|0x80;
+        num >>= 7;
+    }
+    data[len++] = (unsigned char)num;
+    return len;
+}
+
+/* Hash of the source a word at a time, that is a lot faster than
+ * symbol_hash on large files. */
+size_t program_hash(char *data, size_t len) {
+    size_t hash = len;
+    size_t word, i;
+    for(i=0;i<len;i+=sizeof(size_t)){
+        word = 0;
+        memcpy(&word, data+i, len-i < sizeof(size_t) ? len-i :
+               sizeof(size_t));
+        hash = (hash^word)*16777619UL;
+        hash ^= hash>>(sizeof(size_t)*4-1);
+    }
+    return hash;
+}
+
+int program_init(Program *program) {
+    program->data = NULL;
+    program->len = 0;
+    program->max = 0;
+    program->line = 1;
+    program->names = NULL;
+    program->names_len = 0;
+    program->view = 0;
+    return TL_SUCCESS;
+}
+
+int program_put(Program *program, void *data, size_t len) {
+    char *tmp;
+    size_t max = program->max;
+    while(program->len+len > max){
+        max = max ? max*2 : TL_PROGRAM_MIN;
+    }
+    if(max > program->max){
+        tmp = realloc(program->data, max);
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+        program->data = tmp;
+        program->max = max;
+    }
+    memcpy(program->data+program->len, data, len);
+    program->len += len;
+    return TL_SUCCESS;
+}
+
+int program_put_num(Program *program, size_t num) {
+    unsigned char data[TL_NUM_MAX];
+    return program_put(program, data, program_encode(data, num));
+}
+
+/* Stores the type of an event that is at line. */
+int program_put_event(Program *program, unsigned char type, size_t line) {
+    int rc;
+    rc = program_put(program, &type, 1);
+    if(rc) return rc;
+    rc = program_put_num(program, line-program->line);
+    program->line = line;
+    return rc;
+}
+
+int program_open(Program *program, size_t line) {
+    return program_put_event(program, TL_P_OPEN, line);
+}
+
+int program_func(Program *program, size_t symbol) {
+    unsigned char type = TL_P_FUNC;
+    int rc;
+    rc = program_put(program, &type, 1);
+    if(rc) return rc;
+    return program_put_num(program, symbol);
+}
+
+/* The value is a single number, string or name. */
+int program_value(Program *program, Var *value, size_t line) {
+    Item *item = VAR_ITEMS(value);
+    int rc;
+    switch(value->type){
+        case TL_T_NUM:
+            rc = program_put_event(program, TL_P_NUM, line);
+            if(rc) return rc;
+            return program_put(program, &VAR_NUM(*item),
+                               sizeof(TL_FLOAT));
+        case TL_T_INT:
+            rc = program_put_event(program, TL_P_INT, line);
+            if(rc) return rc;
+            return program_put(program, &VAR_INT(*item), sizeof(TL_INT));
+        case TL_T_STR:
+            rc = program_put_event(program, TL_P_STR, line);
+            if(!rc) rc = program_put_num(program, VAR_STR_LEN(*item));
+            if(rc) return rc;
+            return program_put(program, VAR_STR_DATA(*item),
+                               VAR_STR_LEN(*item));
+        case TL_T_NAME:
+            rc = program_put_event(program, TL_P_NAME, line);
+            if(rc) return rc;
+            return program_put_num(program, VAR_SYMBOL(*item));
+        default:
+            return TL_ERR_BAD_TYPE;
+    }
+}
+
+int program_close(Program *program) {
+    unsigned char type = TL_P_CLOSE;
+    return program_put(program, &type, 1);
+}
+
+/* Stores the names of the symbols after the events, that are then moved
+ * to names. */
+int program_set_symbols(Program *program, Symbols *symbols) {
+    String *name;
+    size_t i, len = program->len;
+    int rc;
+    free(program->names);
+    program->names = NULL;
+    program->names_len = 0;
+    rc = program_put_num(program, symbols->num);
+    for(i=0;!rc&&i<symbols->num;i++){
+        name = symbol_name(symbols, i);
+        rc = program_put_num(program, name->len);
+        if(!rc) rc = program_put(program, name->data, name->len);
+    }
+    if(!rc){
+        program->names = malloc(program->len-len);
+        if(!program->names) rc = TL_ERR_OUT_OF_MEM;
+    }
+    if(!rc){
+        program->names_len = program->len-len;
+        memcpy(program->names, program->data+len, program->names_len);
+    }
+    program->len = len;
+    return rc;
+}
+
+int program_write_num(FILE *fp, size_t num) {
+    unsigned char data[TL_NUM_MAX];
+    size_t len = program_encode(data, num);
+    return fwrite(data, 1, len, fp) == len ? TL_SUCCESS : TL_ERR_BAD_INPUT;
+}
+
+/* Writes the program to fp, after a header that identifies the version of
+ * the interpreter and the source it was parsed from, the names of the
+ * symbols and the size of the events. */
+int program_save(Program *program, char *source, size_t sz, FILE *fp) {
+    TL_FLOAT check = TL_PROGRAM_CHECK;
+    unsigned char float_sz = sizeof(TL_FLOAT);
+    unsigned char int_sz = sizeof(TL_INT);
+    int rc;
+    if(fwrite(TL_PROGRAM_MAGIC, 1, 4, fp) != 4) return TL_ERR_BAD_INPUT;
+    if(fwrite(TL_VERSION, 1, sizeof(TL_VERSION), fp) != sizeof(TL_VERSION)){
+        return TL_ERR_BAD_INPUT;
+    }
+    /* The numbers are stored as they are in memory. */
+    if(fwrite(&float_sz, 1, 1, fp) != 1) return TL_ERR_BAD_INPUT;
+    if(fwrite(&int_sz, 1, 1, fp) != 1) return TL_ERR_BAD_INPUT;
+    if(fwrite(&check, sizeof(TL_FLOAT), 1, fp) != 1){
+        return TL_ERR_BAD_INPUT;
+    }
+    rc = program_write_num(fp, program_hash(source, sz));
+    if(!rc) rc = program_write_num(fp, sz);
+    if(rc) return rc;
+    if(fwrite(program->names, 1, program->names_len, fp) !=
+       program->names_len){
+        return TL_ERR_BAD_INPUT;
+    }
+    /* The size of the events shows if the file was cut. */
+    rc = program_write_num(fp, program->len);
+    if(rc) return rc;
+    if(fwrite(program->data, 1, program->len, fp) != program->len){
+        return TL_ERR_BAD_INPUT;
+    }
+    return TL_SUCCESS;
+}
+
+/* Checks that the saved program in data was saved by this version of the
+ * interpreter for source, is complete and can be run. If it is, program is
+ * set to a view of it, that stays valid as long as data. */
+int program_check(char *data, size_t sz, char *source, size_t source_sz,
+                  Program *program) {
+    TL_FLOAT check;
+    size_t hash, len, num, i, start;
+    size_t cur = 4+sizeof(TL_VERSION)+2+sizeof(TL_FLOAT);
+    String name;
+    int rc;
+    if(sz < cur) return TL_ERR_BAD_INPUT;
+    if(memcmp(data, TL_PROGRAM_MAGIC, 4)) return TL_ERR_BAD_INPUT;
+    if(memcmp(data+4, TL_VERSION, sizeof(TL_VERSION))){
+        return TL_ERR_BAD_INPUT;
+    }
+    if(data[4+sizeof(TL_VERSION)] != sizeof(TL_FLOAT)){
+        return TL_ERR_BAD_INPUT;
+    }
+    if(data[5+sizeof(TL_VERSION)] != sizeof(TL_INT)) return TL_ERR_BAD_INPUT;
+    memcpy(&check, data+4+sizeof(TL_VERSION)+2, sizeof(TL_FLOAT));
+    if(check != TL_PROGRAM_CHECK) return TL_ERR_BAD_INPUT;
+    rc = program_read_num(data, sz, &cur, &hash);
+    if(!rc) rc = program_read_num(data, sz, &cur, &len);
+    if(rc) return rc;
+    if(len != source_sz || hash != program_hash(source, source_sz)){
+        return TL_ERR_BAD_INPUT;
+    }
+    start = cur;
+    rc = program_read_num(data, sz, &cur, &num);
+    for(i=0;!rc&&i<num;i++){
+        rc = program_read_str(data, sz, &cur, &name);
+    }
+    if(rc) return rc;
+    program_init(program);
+    program->names = data+start;
+    program->names_len = cur-start;
+    rc = program_read_num(data, sz, &cur, &len);
+    if(rc) return rc;
+    if(len != sz-cur) return TL_ERR_BAD_INPUT;
+    program->data = data+cur;
+    program->len = len;
+    program->view = 1;
+    return program_validate(program);
+}
+
+/* Checks all the events of the program before any of them runs: each call
+ * that ends was started and all of them end, the values are in calls, and
+ * the symbols are in the names. */
+int program_validate(Program *program) {
+    Event event;
+    String name;
+    size_t cur = 0;
+    size_t depth = 0;
+    size_t i, num;
+    int rc;
+    rc = program_read_num(program->names, program->names_len, &cur, &num);
+    for(i=0;!rc&&i<num;i++){
+        rc = program_read_str(program->names, program->names_len, &cur,
+                              &name);
+    }
+    if(rc) return rc;
+    cur = 0;
+    event.line = 1;
+    while(cur < program->len){
+        rc = program_next(program->data, program->len, &cur, &event);
+        if(rc) return rc;
+        if(event.type == TL_P_OPEN){
+            depth++;
+        }else if(!depth){
+            return TL_ERR_BAD_INPUT;
+        }else if(event.type == TL_P_CLOSE){
+            depth--;
+        }else if((event.type == TL_P_FUNC || event.type == TL_P_NAME) &&
+                 event.symbol >= num){
+            return TL_ERR_BAD_INPUT;
+        }
+    }
+    return depth ? TL_ERR_BAD_INPUT : TL_SUCCESS;
+}
+
+int program_read_num(char *data, size_t sz, size_t *cur, size_t *num) {
+    unsigned char c;
+    size_t shift = 0;
+    *num = 0;
+    do{
+        if(*cur >= sz || shift >= sizeof(size_t)*8) return TL_ERR_BAD_INPUT;
+        c = data[(*cur)++];
+        *num |= (size_t)(c&0x7F)<<shift;
+        shift += 7;
+    }while(c&0x80);
+    return TL_SUCCESS;
+}
+
+/* The string points to data. */
+int program_read_str(char *data, size_t sz, size_t *cur, String *string) {
+    int rc;
+    rc = program_read_num(data, sz, cur, &string->len);
+    if(rc) return rc;
+    if(string->len > sz-*cur) return TL_ERR_BAD_INPUT;
+    string->data = data+*cur;
+    *cur += string->len;
+    return TL_SUCCESS;
+}
+
+/* Reads the event at cur. The line of the event is set relative to the
+ * line of the previous one. */
+int program_next(char *data, size_t sz, size_t *cur, Event *event) {
+    size_t line;
+    int rc;
+    if(*cur >= sz) return TL_ERR_BAD_INPUT;
+    event->type = data[(*cur)++];
+    if(event->type == TL_P_CLOSE) return TL_SUCCESS;
+    if(event->type == TL_P_FUNC){
+        return program_read_num(data, sz, cur, &event->symbol);
+    }
+    rc = program_read_num(data, sz, cur, &line);
+    if(rc) return rc;
+    event->line += line;
+    switch(event->type){
+        case TL_P_OPEN:
+            return TL_SUCCESS;
+        case TL_P_NUM:
+            if(sz-*cur < sizeof(TL_FLOAT)) return TL_ERR_BAD_INPUT;
+            memcpy(&event->num, data+*cur, sizeof(TL_FLOAT));
+            *cur += sizeof(TL_FLOAT);
+            return TL_SUCCESS;
+        case TL_P_INT:
+            if(sz-*cur < sizeof(TL_INT)) return TL_ERR_BAD_INPUT;
+            memcpy(&event->integer, data+*cur, sizeof(TL_INT));
+            *cur += sizeof(TL_INT);
+            return TL_SUCCESS;
+        case TL_P_STR:
+            return program_read_str(data, sz, cur, &event->string);
+        case TL_P_NAME:
+            return program_read_num(data, sz, cur, &event->symbol);
+        default:
+            return TL_ERR_BAD_INPUT;
+    }
+}
+
+int program_free(Program *program) {
+    if(!program->view){
+        free(program->data);
+        free(program->names);
+    }
+    program->data = NULL;
+    program->names = NULL;
+    program->names_len = 0;
+    program->len = 0;
+    program->max = 0;
+    return TL_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Programs store the names of their
+ *             symbols, and can be views of a saved program. Integers.
+ *             The check depends on the type of the floats. Check all the
+ *             events of a program before running it.
+ */
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <var.h>
+#include <symbol.h>
+#include <defs.h>
+#include <platform.h>
+
+#define TL_PROGRAM_MIN   256
+#define TL_PROGRAM_MAGIC "LZYC"
+/* Stored in the header to check that the numbers are stored in the same
+ * way, that also differs between fixed point numbers of different
+ * precisions. */
+#define TL_PROGRAM_CHECK NUMBER_DIV(NUMBER_FROM_INT(3), NUMBER_FROM_INT(2))
+
+/* What the parser found, in the order in which it found it:
+ * TL_P_OPEN:  A call starts.
+ * TL_P_FUNC:  Name of the function of the call.
+ * TL_P_NUM:   A number.
+ * TL_P_STR:   A string.
+ * TL_P_NAME:  A name.
+ * TL_P_CLOSE: The call ends.
+ * TL_P_INT:   An integer. */
+enum {
+    TL_P_OPEN,
+    TL_P_FUNC,
+    TL_P_NUM,
+    TL_P_STR,
+    TL_P_NAME,
+    TL_P_CLOSE,
+    TL_P_INT
+};
+
+/* An event read by program_next. The string points to the program. */
+typedef struct {
+    unsigned char type;
+    size_t line;
+    size_t symbol;
+    TL_FLOAT num;
+    TL_INT integer;
+    String string;
+} Event;
+
+/* The events of the parsed code, and the names of the symbols they use.
+ * The lines are stored relative to the line of the previous event. */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t max;
+    size_t line;
+    char *names;
+    size_t names_len;
+    /* The program points to a saved program, and its data is not freed. */
+    char view;
+} Program;
+
+size_t program_hash(char *data, size_t len);
+int program_init(Program *program);
+int program_open(Program *program, size_t line);
+int program_func(Program *program, size_t symbol);
+int program_value(Program *program, Var *value, size_t line);
+int program_close(Program *program);
+int program_set_symbols(Program *program, Symbols *symbols);
+int program_save(Program *program, char *source, size_t sz, FILE *fp);
+int program_check(char *data, size_t sz, char *source, size_t source_sz,
+                  Program *program);
+int program_validate(Program *program);
+int program_read_num(char *data, size_t sz, size_t *cur, size_t *num);
+int program_read_str(char *data, size_t sz, size_t *cur, String *string);
+int program_next(char *data, size_t sz, size_t *cur, Event *event);
+int program_free(Program *program);
+
+#endif
@@ -0,0 +1,141 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Intern the names when parsing.
+ */
+
+#include <symbol.h>
+
+unsigned long symbol_hash(char *data, size_t len) {
+    /* FNV-1a */
+    unsigned long hash = 2166136261UL;
+    size_t i;
+    for(i=0;i<len;i++){
+        hash ^= (unsigned char)data[i];
+        hash = (hash*16777619UL)&0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+int symbol_init(Symbols *symbols) {
+    symbols->names = NULL;
+    symbols->hashes = NULL;
+    symbols->num = 0;
+    symbols->max = 0;
+    symbols->index = NULL;
+    symbols->size = 0;
+    return TL_SUCCESS;
+}
+
+/* Rebuilds the index with size entries. size must be a power of two. */
+int symbol_reindex(Symbols *symbols, size_t size) {
+    size_t *index;
+    size_t i, n;
+    index = malloc(size*sizeof(size_t));
+    if(!index) return TL_ERR_OUT_OF_MEM;
+    for(i=0;i<size;i++){
+        index[i] = 0;
+    }
+    for(i=0;i<symbols->num;i++){
+        n = symbols->hashes[i]&(size-1);
+        while(index[n]) n = (n+1)&(size-1);
+        index[n] = i+1;
+    }
+    free(symbols->index);
+    symbols->index = index;
+    symbols->size = size;
+    return TL_SUCCESS;
+}
+
+int symbol_intern(Symbols *symbols, char *data, size_t len, size_t *symbol) {
+    unsigned long hash;
+    size_t i, n, size;
+    String *names;
+    unsigned long *hashes;
+    int rc;
+    hash = symbol_hash(data, len);
+    if(symbols->size){
+        for(i=hash&(symbols->size-1);symbols->index[i];
+            i=(i+1)&(symbols->size-1)){
+            n = symbols->index[i]-1;
+            if(symbols->hashes[n] != hash) continue;
+            if(symbols->names[n].len != len) continue;
+            if(!memcmp(symbols->names[n].data, data, len)){
+                *symbol = n;
+                return TL_SUCCESS;
+            }
+        }
+    }
+    /* Add a new symbol, keeping the index at most half full. */
+    if(symbols->num >= symbols->max){
+        size = symbols->max ? symbols->max*2 : TL_SYMBOL_MIN_SZ;
+        names = realloc(symbols->names, size*sizeof(String));
+        if(!names) return TL_ERR_OUT_OF_MEM;
+        symbols->names = names;
+        hashes = realloc(symbols->hashes, size*sizeof(unsigned long));
+        if(!hashes) return TL_ERR_OUT_OF_MEM;
+        symbols->hashes = hashes;
+        symbols->max = size;
+    }
+    if((symbols->num+1)*2 > symbols->size){
+        size = symbols->size ? symbols->size*2 : TL_SYMBOL_MIN_SZ;
+        rc = symbol_reindex(symbols, size);
+        if(rc) return rc;
+    }
+    rc = var_raw_str(symbols->names+symbols->num, data, len);
+    if(rc) return rc;
+    symbols->hashes[symbols->num] = hash;
+    for(i=hash&(symbols->size-1);symbols->index[i];
+        i=(i+1)&(symbols->size-1));
+    symbols->index[i] = symbols->num+1;
+    *symbol = symbols->num++;
+    return TL_SUCCESS;
+}
+
+String *symbol_name(Symbols *symbols, size_t symbol) {
+    return symbols->names+symbol;
+}
+
+int symbol_free(Symbols *symbols) {
+    size_t i;
+    for(i=0;i<symbols->num;i++){
+        var_free_str(symbols->names+i);
+    }
+    free(symbols->names);
+    free(symbols->hashes);
+    free(symbols->index);
+    return symbol_init(symbols);
+}
@@ -0,0 +1,186 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Open addressing hash table for the global
+ *             variables. Use the symbols as keys. Pin the variables
+ *             that folded values depend on.
+ */
+
+#include <table.h>
+
+int table_init(Table *table) {
+    table->entries = NULL;
+    table->size = 0;
+    table->used = 0;
+    table->deleted = 0;
+    return TL_SUCCESS;
+}
+
+/* Returns the index of the entry of symbol if found is set, or the index
+ * where it should be inserted. Tombstones are skipped, but the first one is
+ * reused for insertion. The table always contains at least one empty entry,
+ * so the probing always ends. As the symbols are small consecutive integers,
+ * they are used as their own hash. */
+size_t table_lookup(Table *table, size_t symbol, char *found) {
+    size_t mask = table->size-1;
+    size_t i = symbol&mask;
+    size_t insert = table->size;
+    TableEntry *entry;
+    *found = 0;
+    for(;;){
+        entry = table->entries+i;
+        if(entry->state == TL_TABLE_EMPTY){
+            return insert < table->size ? insert : i;
+        }
+        if(entry->state == TL_TABLE_DELETED){
+            if(insert >= table->size) insert = i;
+        }else if(entry->symbol == symbol){
+            *found = 1;
+            return i;
+        }
+        i = (i+1)&mask;
+    }
+}
+
+/* Moves all the entries to a new array of size entries, dropping the
+ * tombstones. size must be a power of two. */
+int table_resize(Table *table, size_t size) {
+    TableEntry *entries;
+    size_t i, n;
+    entries = malloc(size*sizeof(TableEntry));
+    if(!entries) return TL_ERR_OUT_OF_MEM;
+    for(i=0;i<size;i++){
+        entries[i].state = TL_TABLE_EMPTY;
+    }
+    for(i=0;i<table->size;i++){
+        if(table->entries[i].state != TL_TABLE_USED) continue;
+        n = table->entries[i].symbol&(size-1);
+        while(entries[n].state != TL_TABLE_EMPTY) n = (n+1)&(size-1);
+        entries[n] = table->entries[i];
+    }
+    free(table->entries);
+    table->entries = entries;
+    table->size = size;
+    table->deleted = 0;
+    return TL_SUCCESS;
+}
+
+int table_find(Table *table, size_t symbol, Var **var) {
+    size_t i;
+    char found;
+    if(!table->used) return TL_ERR_NOT_DEF;
+    i = table_lookup(table, symbol, &found);
+    if(!found) return TL_ERR_NOT_DEF;
+    *var = &table->entries[i].var;
+    return TL_SUCCESS;
+}
+
+int table_add(Table *table, Var *var, size_t symbol) {
+    size_t i, size;
+    char found;
+    int rc;
+    TableEntry *entry;
+    if(table->used){
+        table_lookup(table, symbol, &found);
+        if(found) return TL_ERR_NAME_EXISTS;
+    }
+    /* Keep the load factor, tombstones included, under 3/4. */
+    if((table->used+table->deleted+1)*4 > table->size*3){
+        size = table->size ? table->size : TL_TABLE_MIN_SZ;
+        while((table->used+1)*2 > size) size *= 2;
+        rc = table_resize(table, size);
+        if(rc) return rc;
+    }
+    i = table_lookup(table, symbol, &found);
+    entry = table->entries+i;
+    if(entry->state == TL_TABLE_DELETED) table->deleted--;
+    entry->symbol = symbol;
+    entry->var = *var;
+    entry->state = TL_TABLE_USED;
+    entry->pinned = 0;
+    table->used++;
+    return TL_SUCCESS;
+}
+
+int table_remove(Table *table, size_t symbol) {
+    size_t i;
+    char found;
+    int rc;
+    TableEntry *entry;
+    if(!table->used) return TL_ERR_NOT_DEF;
+    i = table_lookup(table, symbol, &found);
+    if(!found) return TL_ERR_NOT_DEF;
+    entry = table->entries+i;
+    rc = var_free(&entry->var);
+    if(rc) return rc;
+    entry->state = TL_TABLE_DELETED;
+    table->used--;
+    table->deleted++;
+    return TL_SUCCESS;
+}
+
+int table_pin(Table *table, size_t symbol) {
+    size_t i;
+    char found;
+    if(!table->used) return TL_ERR_NOT_DEF;
+    i = table_lookup(table, symbol, &found);
+    if(!found) return TL_ERR_NOT_DEF;
+    table->entries[i].pinned = 1;
+    return TL_SUCCESS;
+}
+
+/* Tells if the variable of symbol was pinned, and unpins it. */
+int table_unpin(Table *table, size_t symbol, char *pinned) {
+    size_t i;
+    char found;
+    *pinned = 0;
+    if(!table->used) return TL_ERR_NOT_DEF;
+    i = table_lookup(table, symbol, &found);
+    if(!found) return TL_ERR_NOT_DEF;
+    *pinned = table->entries[i].pinned;
+    table->entries[i].pinned = 0;
+    return TL_SUCCESS;
+}
+
+int table_free(Table *table) {
+    size_t i;
+    for(i=0;i<table->size;i++){
+        if(table->entries[i].state != TL_TABLE_USED) continue;
+        var_free(&table->entries[i].var);
+    }
+    free(table->entries);
+    return table_init(table);
+}
@@ -0,0 +1,79 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Use the symbols as keys. Pin the
+ *             variables that folded values depend on.
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <var.h>
+#include <defs.h>
+#include <platform.h>
+
+#define TL_TABLE_MIN_SZ 64
+
+enum {
+    TL_TABLE_EMPTY,
+    TL_TABLE_USED,
+    TL_TABLE_DELETED
+};
+
+typedef struct {
+    size_t symbol;
+    Var var;
+    unsigned char state;
+    /* Set if a value was computed from it, until it is changed. */
+    unsigned char pinned;
+} TableEntry;
+
+typedef struct {
+    TableEntry *entries;
+    size_t size;
+    size_t used;
+    size_t deleted;
+} Table;
+
+int table_init(Table *table);
+int table_find(Table *table, size_t symbol, Var **var);
+int table_add(Table *table, Var *var, size_t symbol);
+int table_remove(Table *table, size_t symbol);
+int table_pin(Table *table, size_t symbol);
+int table_unpin(Table *table, size_t symbol, char *pinned);
+int table_free(Table *table);
+
+#endif
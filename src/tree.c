@@ -36,6 +36,11 @@
  *
  * 2024/10/15: Created this file.
  * 2024/10/19: Adding function definition and calling.
+ * 2026/10/18: Cache the called function in the node. Store the slot of
+ *             parameters, and if parameters are used. Store the code of
+ *             the body of the functions. Allocate the nodes, their
+ *             values and their childs in blocks. Free what was allocated
+ *             after a mark. No folded value.
  */
 
 #include <tree.h>
@@ -45,6 +50,14 @@ int node_init(Node *node, Var *value) {
     node->var = value;
     node->childs = NULL;
     node->childnum = 0;
+    node->cache = NULL;
+    node->epoch = 0;
+    node->is_param = 0;
+    node->slot = 0;
+    node->has_params = 0;
+    node->code = TL_NO_CODE;
+    node->folded = NULL;
+    node->fold_epoch = 0;
     return TL_SUCCESS;
 }
 
@@ -69,15 +82,156 @@ int node_add_child(Node *parent, Node *child) {
     return TL_SUCCESS;
 }
 
-int node_free_childs(Node *parent, void on_node(Node*, void*), void *data) {
-    /* TODO: Avoid recursion. */
+int tree_init(Tree *tree) {
+    tree->nodes = NULL;
+    tree->values = NULL;
+    tree->pending = NULL;
+    tree->pending_cur = 0;
+    tree->pending_max = 0;
+    return TL_SUCCESS;
+}
+
+int tree_alloc(TreeBlock **blocks, size_t size, void **ptr) {
+    TreeBlock *block = *blocks;
+    size_t block_sz;
+    /* Keep the pointers aligned. */
+    size = (size+sizeof(void*)-1)/sizeof(void*)*sizeof(void*);
+    if(!block || block->used+size > block->size){
+        block_sz = size > TL_TREE_BLOCK_SZ ? size : TL_TREE_BLOCK_SZ;
+        block = malloc(sizeof(TreeBlock)+block_sz);
+        if(!block) return TL_ERR_OUT_OF_MEM;
+        block->next = *blocks;
+        block->used = 0;
+        block->size = block_sz;
+        *blocks = block;
+    }
+    *ptr = (char*)(block+1)+block->used;
+    block->used += size;
+    return TL_SUCCESS;
+}
+
+/* Allocate a node with an empty value. */
+int tree_node(Tree *tree, Node **node) {
+    Var *value;
+    int rc;
+    rc = tree_alloc(&tree->values, sizeof(Var), (void**)&value);
+    if(rc) return rc;
+    value->items = NULL;
+    value->size = 0;
+    rc = tree_alloc(&tree->nodes, sizeof(Node), (void**)node);
+    if(rc) return rc;
+    return node_init(*node, value);
+}
+
+/* Allocate a node for a call. The value of a call does not have to be
+ * freed, so it is stored with the nodes. */
+int tree_call(Tree *tree, Node **node) {
+    Var *value;
+    Item *item;
+    int rc;
+    rc = tree_alloc(&tree->nodes, sizeof(Var), (void**)&value);
+    if(rc) return rc;
+    rc = tree_alloc(&tree->nodes, sizeof(Item), (void**)&item);
+    if(rc) return rc;
+    item->call.function = 0;
+    item->call.has_func = 0;
+    value->type = TL_T_CALL;
+    value->items = item;
+    value->size = 1;
+    value->null = 0;
+    rc = tree_alloc(&tree->nodes, sizeof(Node), (void**)node);
+    if(rc) return rc;
+    return node_init(*node, value);
+}
+
+/* The childs are stored in the node by tree_end. */
+int tree_add_child(Tree *tree, Node *parent, Node *child) {
+    Node **tmp;
+    size_t max;
+    if(tree->pending_cur >= tree->pending_max){
+        max = tree->pending_max ? tree->pending_max*2 : TL_TREE_BLOCK_SZ;
+        tmp = realloc(tree->pending, max*sizeof(Node*));
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+        tree->pending = tmp;
+        tree->pending_max = max;
+    }
+    tree->pending[tree->pending_cur++] = child;
+    child->parent = parent;
+    child->idx = parent->childnum;
+    parent->childnum++;
+    return TL_SUCCESS;
+}
+
+int tree_end(Tree *tree, Node *node) {
+    Node **childs;
+    int rc;
+    if(!node->childnum) return TL_SUCCESS;
+    rc = tree_alloc(&tree->nodes, node->childnum*sizeof(Node*),
+                    (void**)&childs);
+    if(rc) return rc;
+    tree->pending_cur -= node->childnum;
+    memcpy(childs, tree->pending+tree->pending_cur,
+           node->childnum*sizeof(Node*));
+    node->childs = childs;
+    return TL_SUCCESS;
+}
+
+int tree_mark(Tree *tree, TreeMark *mark) {
+    mark->nodes = tree->nodes;
+    mark->nodes_used = tree->nodes ? tree->nodes->used : 0;
+    mark->values = tree->values;
+    mark->values_used = tree->values ? tree->values->used : 0;
+    return TL_SUCCESS;
+}
+
+int tree_release(Tree *tree, TreeMark *mark) {
+    TreeBlock *block;
+    Var *values;
     size_t i;
-    for(i=0;i<parent->childnum;i++){
-        node_free_childs(((Node**)parent->childs)[i], on_node, data);
+    /* The blocks allocated after the mark are before it in the list. */
+    while(tree->values != mark->values){
+        block = tree->values;
+        values = (Var*)(block+1);
+        for(i=0;i<block->used/sizeof(Var);i++){
+            var_free(values+i);
+        }
+        tree->values = block->next;
+        free(block);
     }
-    free(parent->childs);
-    parent->childs = NULL;
-    if(parent->var) var_free(parent->var);
-    on_node(parent, data);
+    if(tree->values){
+        values = (Var*)(tree->values+1);
+        for(i=mark->values_used/sizeof(Var);
+            i<tree->values->used/sizeof(Var);i++){
+            var_free(values+i);
+        }
+        tree->values->used = mark->values_used;
+    }
+    while(tree->nodes != mark->nodes){
+        block = tree->nodes;
+        tree->nodes = block->next;
+        free(block);
+    }
+    if(tree->nodes) tree->nodes->used = mark->nodes_used;
     return TL_SUCCESS;
 }
+
+int tree_free(Tree *tree) {
+    TreeBlock *block;
+    TreeBlock *next;
+    Var *values;
+    size_t i;
+    for(block=tree->values;block;block=next){
+        next = block->next;
+        values = (Var*)(block+1);
+        for(i=0;i<block->used/sizeof(Var);i++){
+            var_free(values+i);
+        }
+        free(block);
+    }
+    for(block=tree->nodes;block;block=next){
+        next = block->next;
+        free(block);
+    }
+    free(tree->pending);
+    return tree_init(tree);
+}
@@ -36,6 +36,12 @@
  *
  * 2024/10/15: Created this file.
  * 2024/10/19: Adding function definition and calling.
+ * 2026/10/18: Cache the called function in the node. Store the slot of
+ *             parameters, and if parameters are used. Store the code of
+ *             the body of the functions. Allocate the nodes, their
+ *             values and their childs in blocks. Smaller nodes. Free
+ *             what was allocated after a mark. Folded value of the
+ *             node. Only the slot of the parameters is stored.
  */
 
 #ifndef TREE_H
@@ -45,18 +51,77 @@
 #include <defs.h>
 #include <platform.h>
 
+/* Size of the blocks in which the tree is allocated. */
+#define TL_TREE_BLOCK_SZ 4096
+
+/* The counts and indices of the nodes are stored on 32 bits. */
 typedef struct {
     Var *var;
     void *childs;
     void *parent;
-    size_t idx;
-    size_t childnum;
-    size_t line;
+    /* Function called by this node, valid if epoch is the epoch of the
+     * interpreter. */
+    Function *cache;
+    size_t epoch;
+    /* Bytecode of the body of the function defined by this node, compiled
+     * when it is called for the first time. */
+    size_t code;
+    /* Value of the call computed by the optimizer, valid if fold_epoch is
+     * the fold epoch of the interpreter. */
+    Var *folded;
+    size_t fold_epoch;
+    unsigned int idx;
+    unsigned int childnum;
+    unsigned int line;
+    /* If the node is a parameter of the function it is used in, the
+     * argument is at the index slot of the frame of the function. */
+    unsigned int slot;
+    char is_param;
+    /* Set if a parameter is used by this node or one of its childs. */
+    char has_params;
     char has_value;
 } Node;
 
+typedef struct TreeBlock {
+    struct TreeBlock *next;
+    size_t used;
+    size_t size;
+} TreeBlock;
+
+/* The nodes, their values and the arrays of their childs are allocated one
+ * after the other in blocks, that are never moved so that the pointers to
+ * them stay valid while more code is parsed. The values have their own
+ * blocks, that only contain Vars, so that they can be freed by going
+ * through the blocks. */
+typedef struct {
+    TreeBlock *nodes;
+    TreeBlock *values;
+    /* Childs of the calls that are being parsed, the last ones are the
+     * childs of the innermost call. */
+    Node **pending;
+    size_t pending_cur;
+    size_t pending_max;
+} Tree;
+
+/* Position in the blocks, to free what was allocated after. */
+typedef struct {
+    TreeBlock *nodes;
+    size_t nodes_used;
+    TreeBlock *values;
+    size_t values_used;
+} TreeMark;
+
 int node_init(Node *node, Var *value);
 int node_add_child(Node *parent, Node *child);
-int node_free_childs(Node *parent, void on_node(Node*, void*), void *data);
+
+int tree_init(Tree *tree);
+int tree_alloc(TreeBlock **blocks, size_t size, void **ptr);
+int tree_node(Tree *tree, Node **node);
+int tree_call(Tree *tree, Node **node);
+int tree_add_child(Tree *tree, Node *parent, Node *child);
+int tree_end(Tree *tree, Node *node);
+int tree_mark(Tree *tree, TreeMark *mark);
+int tree_release(Tree *tree, TreeMark *mark);
+int tree_free(Tree *tree);
 
 #endif
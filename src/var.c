@@ -45,75 +45,135 @@
  *             var_call: initialize a Var.
  * 2024/10/18: Fixed builtin function prototype.
  * 2024/10/20: Better name.
+ * 2026/10/18: Names and calls store the symbol of the name instead of a copy
+ *             of it. Store how the arguments of builtins are evaluated.
+ *             Single numbers, strings and names are not allocated.
+ *             Lists and the data of strings are reference counted and
+ *             copied on write. Move a Var. The function takes the
+ *             parameters. Strings of at most one character are not
+ *             allocated. Numbers without a dot are integers, that become
+ *             floats when appended to floats. The other numbers are
+ *             parsed depending on their type. TL_INT_MIN is an
+ *             integer. String literals of the code are views of it instead
+ *             of copies. Copies of functions get their own parameters.
  */
 
 #include <var.h>
 
-int var_auto(Var *var, char *data, size_t len) {
-    if(var_isnum(data, len)){
-        var_num(var, data, len);
-        return TL_SUCCESS;
-    }else if(var_isname(data, len)){
-        var_str(var, data, len);
-        var->type = TL_T_NAME;
-        return TL_SUCCESS;
-    }
-    return TL_ERR_UNKNOWN_TYPE;
-}
+/* Strings of at most one character share these blocks instead of being
+ * allocated. The table keeps a reference to each of them, so they are
+ * never freed or resized, and are copied before being changed. */
+static struct {
+    Shared shared;
+    char c;
+} var_chars[256];
+static char var_chars_init = 0;
 
 int var_str(Var *var, char *data, size_t len) {
     var->type = TL_T_STR;
-    var->items = malloc(sizeof(Item));
-    if(!var->items){
-        return TL_ERR_OUT_OF_MEM;
-    }
+    var->items = NULL;
     var->size = 1;
-    var->items->string.data = malloc(len);
-    if(!var->items->string.data){
+    var->item.string.len = len;
+    var->item.string.view = 0;
+    var->null = 0;
+    if(len <= 1){
+        var->item.string.data = var_char(len ? data[0] : 0);
+        return TL_SUCCESS;
+    }
+    var->item.string.data = var_shared_alloc(len);
+    if(!var->item.string.data){
         return TL_ERR_OUT_OF_MEM;
     }
-    var->items->string.len = len;
-    if(!memcpy(var->items->string.data, data, len)){
+    if(!memcpy(var->item.string.data, data, len)){
         return TL_ERR_CPY;
     }
+    return TL_SUCCESS;
+}
+
+/* The data is not copied, it has to stay valid as long as the string. */
+int var_str_view(Var *var, char *data, size_t len) {
+    if(len <= 1) return var_str(var, data, len);
+    var->type = TL_T_STR;
+    var->items = NULL;
+    var->size = 1;
+    var->item.string.data = data;
+    var->item.string.len = len;
+    var->item.string.view = 1;
     var->null = 0;
     return TL_SUCCESS;
 }
 
+char *var_char(char c) {
+    size_t i;
+    if(!var_chars_init){
+        for(i=0;i<256;i++){
+            var_chars[i].shared.refs = 1;
+            var_chars[i].c = (char)i;
+        }
+        var_chars_init = 1;
+    }
+    return var_shared_ref(&var_chars[(unsigned char)c].c);
+}
+
+void var_str_ref(String *string) {
+    if(!string->view) var_shared_ref(string->data);
+}
+
+void var_str_unref(String *string) {
+    if(!string->view && var_shared_unref(string->data)){
+        var_shared_free(string->data);
+    }
+}
+
 int var_str_concat(Var *var, Var *str1, Var *str2) {
+    String *a = &VAR_ITEMS(str1)->string;
+    String *b = &VAR_ITEMS(str2)->string;
     var->type = TL_T_STR;
-    var->items = malloc(sizeof(Item));
-    if(!var->items){
-        return TL_ERR_OUT_OF_MEM;
-    }
+    var->items = NULL;
     var->size = 1;
-    var->items->string.len = str1->items->string.len+str2->items->string.len;
-    var->items->string.data = malloc(var->items->string.len);
-    if(!var->items->string.data){
+    var->null = 0;
+    /* Share the data when one of them is empty. */
+    if(!a->len || !b->len){
+        var->item.string = a->len ? *a : *b;
+        var_str_ref(&var->item.string);
+        return TL_SUCCESS;
+    }
+    var->item.string.len = a->len+b->len;
+    var->item.string.view = 0;
+    var->item.string.data = var_shared_alloc(var->item.string.len);
+    if(!var->item.string.data){
         return TL_ERR_OUT_OF_MEM;
     }
-    if(!memcpy(var->items->string.data, str1->items->string.data,
-               str1->items->string.len)){
+    if(!memcpy(var->item.string.data, a->data, a->len)){
         return TL_ERR_CPY;
     }
-    if(!memcpy(var->items->string.data+str1->items->string.len,
-               str2->items->string.data, str2->items->string.len)){
+    if(!memcpy(var->item.string.data+a->len, b->data, b->len)){
         return TL_ERR_CPY;
     }
-    var->null = 0;
     return TL_SUCCESS;
 }
 
 int var_str_add(Var *var, char *data, size_t len) {
+    String *string;
     char *tmp;
     if(var->type != TL_T_STR) return TL_ERR_BAD_TYPE;
-    tmp = realloc(var->items->string.data, var->items->string.len+len);
-    if(!tmp) return TL_ERR_OUT_OF_MEM;
-    var->items->string.data = tmp;
-    if(!memcpy(var->items->string.data+var->items->string.len, data, len)){
+    string = &VAR_ITEMS(var)->string;
+    if(string->view || VAR_REFS(string->data) > 1){
+        /* Copy on write. */
+        tmp = var_shared_alloc(string->len+len);
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+        memcpy(tmp, string->data, string->len);
+        var_str_unref(string);
+        string->view = 0;
+    }else{
+        tmp = var_shared_resize(string->data, string->len+len);
+        if(!tmp) return TL_ERR_OUT_OF_MEM;
+    }
+    string->data = tmp;
+    if(!memcpy(string->data+string->len, data, len)){
         return TL_ERR_CPY;
     }
-    var->items->string.len += len;
+    string->len += len;
     return TL_SUCCESS;
 }
 
@@ -130,7 +190,7 @@ int var_raw_str(String *string, char *data, size_t len) {
 }
 
 int var_builtin_func(Var *var, int f(void*, void*, size_t, void*),
-                     char parse) {
+                     char eval) {
     var->type = TL_T_FUNC;
     var->items = malloc(sizeof(Item));
     if(!var->items){
@@ -140,12 +200,11 @@ int var_builtin_func(Var *var, int f(void*, void*, size_t, void*),
     var->null = 0;
     var->items->function.ptr.f = f;
     var->items->function.builtin = 1;
-    var->items->function.parseargs = parse;
+    var->items->function.eval = eval;
     return TL_SUCCESS;
 }
 
 int var_user_func(Var *var, void *fncdef, Var *params) {
-    int rc;
     var->type = TL_T_FUNC;
     var->items = malloc(sizeof(Item));
     if(!var->items){
@@ -155,15 +214,13 @@ int var_user_func(Var *var, void *fncdef, Var *params) {
     var->null = 0;
     var->items->function.ptr.fncdef = fncdef;
     var->items->function.builtin = 0;
-    var->items->function.parseargs = 1;
+    var->items->function.eval = TL_ARGS_EVAL;
     var->items->function.params = malloc(sizeof(Var));
     if(!var->items->function.params){
         free(var->items);
         return TL_ERR_OUT_OF_MEM;
     }
-    rc = var_copy(params, var->items->function.params);
-    if(rc) return rc;
-    return TL_SUCCESS;
+    return var_move(params, var->items->function.params);
 }
 
 char var_isnum(char *data, size_t len) {
@@ -190,51 +247,80 @@ char var_isnum(char *data, size_t len) {
 
 int var_num(Var *var, char *data, size_t len) {
     /* TODO: Add support for exponent */
-    float sign = 1;
-    float d = 0.1;
-    float out = 0;
+    unsigned long mag = 0;
+    unsigned long max;
+    char negative = 0;
     char c;
     size_t i;
-    var->type = TL_T_NUM;
-    var->items = malloc(sizeof(Item));
-    if(!var->items){
-        return TL_ERR_OUT_OF_MEM;
-    }
-    var->size = 1;
-    if(data[0] == '-'){
-        sign = -1;
-        data++;
-        len--;
+    if(data[0] == '-') negative = 1;
+    /* Numbers without a dot are integers if they fit, down to TL_INT_MIN
+     * whose magnitude is bigger than TL_INT_MAX. */
+    max = negative ? -(unsigned long)TL_INT_MIN : (unsigned long)TL_INT_MAX;
+    for(i=negative;i<len;i++){
+        c = data[i]-'0';
+        if(c < 0 || c > 9 || mag > (max-c)/10) break;
+        mag = mag*10+c;
     }
-    for(i=0;i<len;i++){
-        c = data[i];
-        if(c == '.') break;
-        d *= 10;
-    }
-    for(i=0;i<len;i++){
-        c = data[i];
-        if(c != '.'){
-            out += (c-'0')*d;
-            d /= 10;
-        }
+    if(i == len){
+        return var_int(var, negative && mag ? -(TL_INT)(mag-1)-1 :
+                            (TL_INT)mag);
     }
-    var->items->num = out*sign;
+    var->type = TL_T_NUM;
+    var->items = NULL;
+    var->size = 1;
     var->null = 0;
-    return TL_SUCCESS;
+    return number_parse(&var->item.num, data, len);
 }
 
-int var_num_from_float(Var *var, float num) {
+int var_num_from_float(Var *var, TL_FLOAT num) {
     var->type = TL_T_NUM;
-    var->items = malloc(sizeof(Item));
-    if(!var->items){
-        return TL_ERR_OUT_OF_MEM;
-    }
+    var->items = NULL;
     var->size = 1;
-    var->items->num = num;
+    var->item.num = num;
     var->null = 0;
     return TL_SUCCESS;
 }
 
+int var_int(Var *var, TL_INT integer) {
+    var->type = TL_T_INT;
+    var->items = NULL;
+    var->size = 1;
+    var->item.integer = integer;
+    var->null = 0;
+    return TL_SUCCESS;
+}
+
+/* Turns the integers of var into floats, copying them first if they are
+ * shared. */
+int var_to_float(Var *var) {
+    Item *items;
+    TL_FLOAT num;
+    size_t i;
+    if(var->type != TL_T_INT) return TL_SUCCESS;
+    var->type = TL_T_NUM;
+    if(VAR_IS_INLINE(var)){
+        num = NUMBER_FROM_INT(var->item.integer);
+        var->item.num = num;
+        return TL_SUCCESS;
+    }
+    if(!var->size || !var->items) return TL_SUCCESS;
+    if(VAR_REFS(var->items) > 1){
+        items = var_shared_alloc(var->size*sizeof(Item));
+        if(!items){
+            var->type = TL_T_INT;
+            return TL_ERR_OUT_OF_MEM;
+        }
+        for(i=0;i<var->size;i++) items[i] = var->items[i];
+        var_shared_unref(var->items);
+        var->items = items;
+    }
+    for(i=0;i<var->size;i++){
+        num = NUMBER_FROM_INT(var->items[i].integer);
+        var->items[i].num = num;
+    }
+    return TL_SUCCESS;
+}
+
 char var_isname(char *data, size_t len) {
     char c;
     if(len < 1) return 0;
@@ -243,99 +329,95 @@ char var_isname(char *data, size_t len) {
     return 1;
 }
 
+int var_name(Var *var, size_t symbol) {
+    var->type = TL_T_NAME;
+    var->items = NULL;
+    var->size = 1;
+    var->item.symbol = symbol;
+    var->null = 0;
+    return TL_SUCCESS;
+}
+
 int var_copy(Var *src, Var *dest) {
     size_t i;
-    if(!src->size || !src->items){
+    int rc;
+    dest->type = src->type;
+    dest->items = NULL;
+    dest->null = 0;
+    if(!src->size || (!src->items && !VAR_IS_INLINE(src))){
         dest->size = 0;
-        dest->items = NULL;
         return TL_SUCCESS;
     }
-    switch(src->type){
-        case TL_T_NAME:
-            dest->type = TL_T_NAME;
-            dest->items = malloc(src->size*sizeof(Item));
-            if(!dest->items){
-                return TL_ERR_OUT_OF_MEM;
-            }
-            dest->size = src->size;
-            for(i=0;i<src->size;i++){
-                dest->items[i].string.data = malloc(src->items[i].string.len);
-                if(!dest->items[i].string.data){
-                    return TL_ERR_OUT_OF_MEM;
-                }
-                dest->items[i].string.len = src->items[i].string.len;
-                if(!memcpy(dest->items[i].string.data,
-                           src->items[i].string.data,
-                           src->items[i].string.len)){
-                    return TL_ERR_CPY;
-                }
-            }
-            dest->null = 0;
-            break;
-        case TL_T_STR:
-            dest->type = TL_T_STR;
-            dest->items = malloc(src->size*sizeof(Item));
-            if(!dest->items){
-                return TL_ERR_OUT_OF_MEM;
-            }
-            dest->size = src->size;
-            for(i=0;i<src->size;i++){
-                dest->items[i].string.data = malloc(src->items[i].string.len);
-                if(!dest->items[i].string.data){
-                    return TL_ERR_OUT_OF_MEM;
-                }
-                dest->items[i].string.len = src->items[i].string.len;
-                if(!memcpy(dest->items[i].string.data,
-                           src->items[i].string.data,
-                           src->items[i].string.len)){
-                    return TL_ERR_CPY;
-                }
-            }
-            dest->null = 0;
-            break;
-        case TL_T_NUM:
-            dest->type = TL_T_NUM;
-            dest->items = malloc(src->size*sizeof(Item));
-            if(!dest->items){
-                return TL_ERR_OUT_OF_MEM;
-            }
-            dest->size = src->size;
-            dest->null = 0;
-            for(i=0;i<src->size;i++){
-                dest->items[i].num = src->items[i].num;
-            }
-            break;
-        case TL_T_FUNC:
-            dest->type = TL_T_FUNC;
-            dest->items = malloc(src->size*sizeof(Item));
-            if(!dest->items){
-                return TL_ERR_OUT_OF_MEM;
-            }
-            dest->size = src->size;
-            dest->null = 0;
-            for(i=0;i<src->size;i++){
-                dest->items[i].function = src->items[i].function;
-            }
-            break;
-        case TL_T_CALL:
-            dest->type = TL_T_CALL;
-            dest->items = malloc(src->size*sizeof(Item));
-            if(!dest->items){
-                return TL_ERR_OUT_OF_MEM;
-            }
-            dest->size = src->size;
-            dest->null = 0;
-            for(i=0;i<src->size;i++){
-                dest->items[i].call = src->items[i].call;
+    if(src->type > TL_T_CALL) return TL_ERR_BAD_TYPE;
+    dest->size = src->size;
+    if(VAR_IS_INLINE(src)){
+        dest->item = src->item;
+        if(src->type == TL_T_STR) var_str_ref(&dest->item.string);
+    }else if(VAR_IS_SHARED(src)){
+        dest->items = var_shared_ref(src->items);
+    }else{
+        dest->items = malloc(src->size*sizeof(Item));
+        if(!dest->items){
+            dest->size = 0;
+            return TL_ERR_OUT_OF_MEM;
+        }
+        for(i=0;i<src->size;i++){
+            dest->items[i] = src->items[i];
+            if(src->type != TL_T_FUNC) continue;
+            rc = var_copy_params(&dest->items[i].function);
+            if(rc){
+                dest->size = i;
+                var_free(dest);
+                free(dest->items);
+                dest->items = NULL;
+                dest->size = 0;
+                return rc;
             }
-            break;
-        default:
-            return TL_ERR_BAD_TYPE;
+        }
     }
     return TL_SUCCESS;
 }
 
-int var_call(Var *var, char *name, size_t len) {
+/* A copy of a user defined function gets its own parameters, that are
+ * freed with it. */
+int var_copy_params(Function *function) {
+    Var *params;
+    int rc;
+    if(function->builtin) return TL_SUCCESS;
+    params = malloc(sizeof(Var));
+    if(!params) return TL_ERR_OUT_OF_MEM;
+    rc = var_copy(function->params, params);
+    if(rc){
+        free(params);
+        return rc;
+    }
+    function->params = params;
+    return TL_SUCCESS;
+}
+
+/* Give the value of src to dest, src is then empty. */
+int var_move(Var *src, Var *dest) {
+    *dest = *src;
+    src->items = NULL;
+    src->size = 0;
+    return TL_SUCCESS;
+}
+
+int var_item(Var *src, size_t index, Var *dest) {
+    if(index >= src->size) return TL_ERR_OUT_OF_RANGE;
+    if(src->type == TL_T_FUNC || src->type == TL_T_CALL){
+        return TL_ERR_BAD_TYPE;
+    }
+    dest->type = src->type;
+    dest->items = NULL;
+    dest->size = 1;
+    dest->null = 0;
+    dest->item = VAR_GET_ITEM(src, index);
+    if(src->type == TL_T_STR) var_str_ref(&dest->item.string);
+    return TL_SUCCESS;
+}
+
+int var_call(Var *var) {
     var->type = TL_T_CALL;
     var->items = malloc(sizeof(Item));
     if(!var->items){
@@ -343,18 +425,40 @@ int var_call(Var *var, char *name, size_t len) {
     }
     var->size = 1;
     var->null = 0;
-    var->items->call.function.data = malloc(len);
-    if(!var->items->call.function.data){
-        return TL_ERR_OUT_OF_MEM;
-    }
-    var->items->call.function.len = len;
-    if(!memcpy(var->items->call.function.data, name, len)){
-        return TL_ERR_CPY;
-    }
+    var->items->call.function = 0;
     var->items->call.has_func = 0;
     return TL_SUCCESS;
 }
 
+void *var_shared_alloc(size_t size) {
+    Shared *shared = malloc(sizeof(Shared)+size);
+    if(!shared) return NULL;
+    shared->refs = 1;
+    return shared+1;
+}
+
+/* The data must not be shared. */
+void *var_shared_resize(void *data, size_t size) {
+    Shared *shared = realloc((Shared*)data-1, sizeof(Shared)+size);
+    if(!shared) return NULL;
+    return shared+1;
+}
+
+void *var_shared_ref(void *data) {
+    VAR_REFS(data)++;
+    return data;
+}
+
+/* Returns 1 if it was the last reference, the data then has to be freed
+ * with var_shared_free. */
+char var_shared_unref(void *data) {
+    return !--VAR_REFS(data);
+}
+
+void var_shared_free(void *data) {
+    free((Shared*)data-1);
+}
+
 int var_free_str(String *string) {
     free(string->data);
     string->data = NULL;
@@ -363,18 +467,29 @@ int var_free_str(String *string) {
 
 int var_free(Var *var) {
     size_t i;
-    if(!var->items || !var->size) return TL_SUCCESS;
+    if(!var->size) return TL_SUCCESS;
+    if(VAR_IS_INLINE(var)){
+        if(var->type == TL_T_STR) var_str_unref(&var->item.string);
+        var->size = 0;
+        return TL_SUCCESS;
+    }
+    if(!var->items) return TL_SUCCESS;
     switch(var->type){
         case TL_T_NAME:
-            /* FALLTHRU */
         case TL_T_STR:
-            for(i=0;i<var->size;i++){
-                free(var->items[i].string.data);
-                var->items[i].string.data = NULL;
-            }
-            break;
         case TL_T_NUM:
-            break;
+        case TL_T_INT:
+            if(var_shared_unref(var->items)){
+                if(var->type == TL_T_STR){
+                    for(i=0;i<var->size;i++){
+                        var_str_unref(&var->items[i].string);
+                    }
+                }
+                var_shared_free(var->items);
+            }
+            var->items = NULL;
+            var->size = 0;
+            return TL_SUCCESS;
         case TL_T_FUNC:
             for(i=0;i<var->size;i++){
                 if(!var->items[i].function.builtin){
@@ -385,9 +500,6 @@ int var_free(Var *var) {
             }
             break;
         case TL_T_CALL:
-            free(var->items->call.function.data);
-            var->items->call.function.data = NULL;
-            var->items->call.function.len = 0;
             break;
         default:
             return TL_ERR_UNKNOWN_TYPE;
@@ -399,21 +511,58 @@ int var_free(Var *var) {
 }
 
 int var_append(Var *src, Var *dest) {
+    Item *src_items;
     Item *tmp;
-    Var src_copy;
+    size_t size;
+    size_t i;
     int rc;
-    rc = var_copy(src, &src_copy);
-    if(rc) return rc;
+    /* The integers become floats if they are appended to floats, or the
+     * other way around. */
+    if(VAR_IS_NUMBER(src) && VAR_IS_NUMBER(dest) && src->type != dest->type){
+        if(!dest->size) return var_copy(src, dest);
+        if(!src->size) return TL_SUCCESS;
+        rc = var_to_float(src->type == TL_T_INT ? src : dest);
+        if(rc) return rc;
+    }
     if(src->type != dest->type) return TL_ERR_BAD_TYPE;
-    tmp = realloc(dest->items, (dest->size+src->size)*sizeof(Item));
+    if(!src->size || (!src->items && !VAR_IS_INLINE(src))){
+        return TL_SUCCESS;
+    }
+    if(!dest->size) return var_copy(src, dest);
+    size = dest->size+src->size;
+    src_items = VAR_ITEMS(src);
+    if(dest->type == TL_T_FUNC || dest->type == TL_T_CALL){
+        tmp = realloc(dest->items, size*sizeof(Item));
+    }else if(VAR_IS_INLINE(dest)){
+        /* It does not fit in the Var anymore. */
+        tmp = var_shared_alloc(size*sizeof(Item));
+        if(tmp) tmp[0] = dest->item;
+    }else if(VAR_REFS(dest->items) > 1){
+        /* Copy on write. */
+        tmp = var_shared_alloc(size*sizeof(Item));
+        if(tmp){
+            for(i=0;i<dest->size;i++){
+                tmp[i] = dest->items[i];
+                if(dest->type == TL_T_STR) var_str_ref(&tmp[i].string);
+            }
+            var_shared_unref(dest->items);
+        }
+    }else{
+        tmp = var_shared_resize(dest->items, size*sizeof(Item));
+    }
     if(!tmp) return TL_ERR_OUT_OF_MEM;
     dest->items = tmp;
-    if(!memcpy(dest->items+dest->size, src_copy.items,
-               src->size*sizeof(Item))){
-        return TL_ERR_CPY;
+    for(i=0;i<src->size;i++){
+        tmp[dest->size+i] = src_items[i];
+        if(dest->type == TL_T_STR) var_str_ref(&tmp[dest->size+i].string);
+        if(dest->type != TL_T_FUNC) continue;
+        rc = var_copy_params(&tmp[dest->size+i].function);
+        if(rc){
+            dest->size += i;
+            return rc;
+        }
     }
-    dest->size += src->size;
-    free(src_copy.items);
+    dest->size = size;
     return TL_SUCCESS;
 }
 
@@ -46,27 +46,65 @@
  * 2024/10/16: Removed useless values in structs.
  * 2024/10/18: Fixed builtin function prototype.
  * 2024/10/20: Better name.
+ * 2026/10/18: Names and calls store the symbol of the name. Store how the
+ *             arguments of builtins are evaluated. Store single numbers,
+ *             strings and names in the Var. Share lists and the data of
+ *             strings between copies. Move a Var.
+ *             Strings of at most one character are not allocated.
+ *             Integers. The floats can be doubles or fixed point numbers.
+ *             Strings can be views of the code. Copy the parameters of a
+ *             function.
  */
 
 #ifndef VAR_H
 #define VAR_H
 
 #include <defs.h>
+#include <number.h>
 
 #define VAR_LEN(var) (var)->size
-#define VAR_GET_ITEM(var, i) (var)->items[i]
+/* A single number, string or name is stored in item instead of being
+ * allocated. Functions and calls are always allocated, so that pointers to
+ * them stay valid when the Var is moved. */
+#define VAR_IS_INLINE(var) ((var)->size == 1 && \
+                            (var)->type != TL_T_FUNC && \
+                            (var)->type != TL_T_CALL)
+#define VAR_ITEMS(var) (VAR_IS_INLINE(var) ? &(var)->item : (var)->items)
+#define VAR_GET_ITEM(var, i) VAR_ITEMS(var)[i]
+/* Lists of numbers, strings and names, and the data of strings, are shared
+ * between copies. They are allocated after a Shared header that counts the
+ * references, and are copied before being changed if there is more than
+ * one. */
+#define VAR_IS_SHARED(var) ((var)->size > 1 && \
+                            (var)->type != TL_T_FUNC && \
+                            (var)->type != TL_T_CALL)
+#define VAR_REFS(data) (((Shared*)(data))-1)->refs
 #define VAR_STR_DATA(item) (item).string.data
 #define VAR_STR_LEN(item) (item).string.len
+#define VAR_SYMBOL(item) (item).symbol
 #define VAR_NUM(item) (item).num
+#define VAR_INT(item) (item).integer
+#define VAR_IS_NUMBER(var) ((var)->type == TL_T_NUM || \
+                            (var)->type == TL_T_INT)
+/* Value of a single number as a float, as an index, and if it is not 0. */
+#define VAR_FLOAT(var) ((var)->type == TL_T_INT ? \
+                        NUMBER_FROM_INT(VAR_ITEMS(var)->integer) : \
+                        VAR_ITEMS(var)->num)
+#define VAR_INDEX(var) ((var)->type == TL_T_INT ? VAR_ITEMS(var)->integer : \
+                        NUMBER_TO_INT(VAR_ITEMS(var)->num))
+#define VAR_IS_TRUE(var) ((var)->type == TL_T_INT ? \
+                          VAR_ITEMS(var)->integer != 0 : \
+                          VAR_ITEMS(var)->num != 0)
 #define VAR_BUILTIN_FUNC(item) (item).function.ptr.f
 #define VAR_IS_BUILTIN(item) (item).function.builtin
-#define VAR_PARSEARGS(item) (item).function.parseargs
+#define VAR_EVAL(item) (item).function.eval
 #define VAR_USER_FUNC(item) (item).function.ptr.start
 
 enum {
     TL_T_FUNC,
     TL_T_STR,
     TL_T_NUM,
+    TL_T_INT,
     TL_T_NAME,
     TL_T_CALL
 };
@@ -74,26 +112,53 @@ enum {
 typedef struct {
     char *data;
     size_t len;
+    /* The data is a view of the code, that outlives the string, instead of
+     * a shared block. It is not reference counted, and is copied before
+     * being changed. */
+    char view;
 } String;
 
+/* The union aligns the shared data like malloc would. */
+typedef union {
+    size_t refs;
+    void *ptr;
+    double num;
+} Shared;
+
+/* Arguments of a builtin that are evaluated before calling it:
+ * TL_ARGS_RAW:   None.
+ * TL_ARGS_EVAL:  All of them.
+ * TL_ARGS_CALLS: The calls, but not the names.
+ * TL_ARGS_NAME:  All of them except the first one.
+ * TL_ARGS_FIRST: Only the first one. */
+enum {
+    TL_ARGS_RAW,
+    TL_ARGS_EVAL,
+    TL_ARGS_CALLS,
+    TL_ARGS_NAME,
+    TL_ARGS_FIRST
+};
+
 typedef struct {
     union {
         void *fncdef;
         int (*f)(void *lisp, void* node, size_t argnum, void* returned);
     } ptr;
     char builtin;
-    char parseargs;
+    char eval;
     void *params;
 } Function;
 
 typedef struct {
-    String function;
+    size_t function;
     char has_func;
 } Call;
 
 typedef union {
-    float num;
+    TL_FLOAT num;
+    TL_INT integer;
     String string;
+    size_t symbol;
     Function function;
     Call call;
 } Item;
@@ -103,22 +168,38 @@ typedef struct {
     size_t size;
     unsigned char type;
     char null;
+    Item item;
 } Var;
 
-int var_auto(Var *var, char *data, size_t len);
 int var_str(Var *var, char *data, size_t len);
+int var_str_view(Var *var, char *data, size_t len);
 int var_str_concat(Var *var, Var *str1, Var *str2);
 int var_str_add(Var *var, char *data, size_t len);
 int var_raw_str(String *string, char *data, size_t len);
+char *var_char(char c);
+void var_str_ref(String *string);
+void var_str_unref(String *string);
 int var_builtin_func(Var *var, int f(void*, void*, size_t, void*),
-                     char parse);
+                     char eval);
 int var_user_func(Var *var, void *fncdef, Var *params);
 char var_isnum(char *data, size_t len);
 int var_num(Var *var, char *data, size_t len);
-int var_num_from_float(Var *var, float num);
+int var_num_from_float(Var *var, TL_FLOAT num);
+int var_int(Var *var, TL_INT integer);
+int var_to_float(Var *var);
 char var_isname(char *data, size_t len);
+int var_name(Var *var, size_t symbol);
 int var_copy(Var *src, Var *dest);
-int var_call(Var *var, char *name, size_t len);
+int var_copy_params(Function *function);
+int var_move(Var *src, Var *dest);
+int var_item(Var *src, size_t index, Var *dest);
+int var_call(Var *var);
+
+void *var_shared_alloc(size_t size);
+void *var_shared_resize(void *data, size_t size);
+void *var_shared_ref(void *data);
+char var_shared_unref(void *data);
+void var_shared_free(void *data);
 
 int var_free_call(Call *call);
 int var_free_str(String *string);
@@ -0,0 +1,408 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file. Check the values folded by the
+ *             optimizer. Integer conditions. Tail calls do not evaluate
+ *             their arguments. Remove the frames when there is an error.
+ */
+
+#include <vm.h>
+#include <call.h>
+#include <compile.h>
+
+int vm_run(LizyLang *lisp, size_t pc, Var *returned) {
+    Bytecode *bc = &lisp->bc;
+    Site *site;
+    Cont *cont;
+    Function *function;
+    Var *var;
+    Var value;
+    size_t root, start, a, code;
+    int rc;
+    char done = 0;
+    root = lisp->conts_cur;
+    rc = call_cont(lisp, TL_K_VROOT, lisp->context, &cont);
+    if(rc) return rc;
+    cont->base = lisp->values_cur;
+    while(!done){
+        start = pc;
+        a = TL_OP_HAS_ARG(bc->code[pc]) ? TL_BC_ARG(bc->code, pc+1) : 0;
+        rc = TL_SUCCESS;
+        switch(bc->code[pc]){
+            case TL_OP_CONST:
+                rc = var_copy(bc->consts+a, &value);
+                if(!rc) rc = vm_push(lisp, &value);
+                pc += 5;
+                break;
+            case TL_OP_GLOBAL:
+                rc = tl_get_var(lisp, a, &var);
+                if(!rc) rc = var_copy(var, &value);
+                if(!rc) rc = vm_push(lisp, &value);
+                pc += 5;
+                break;
+            case TL_OP_PARAM:
+                rc = vm_param(lisp, a, &pc);
+                break;
+            case TL_OP_EMPTY:
+                value.type = TL_T_NUM;
+                value.items = NULL;
+                value.size = 0;
+                value.null = 0;
+                rc = vm_push(lisp, &value);
+                pc++;
+                break;
+            case TL_OP_POP:
+                var_free(lisp->values+--lisp->values_cur);
+                pc++;
+                break;
+            case TL_OP_PARSE:
+                rc = call_parse_value(lisp, lisp->values+lisp->values_cur-1);
+                pc++;
+                break;
+            case TL_OP_GUARD:
+                site = bc->sites+a;
+                if(site->function.builtin){
+                    rc = call_find(lisp, site->node, site->symbol,
+                                   &function);
+                    if(rc) break;
+                    site = bc->sites+a;
+                    if(function->builtin &&
+                       function->ptr.f == site->function.ptr.f &&
+                       function->eval == site->function.eval){
+                        pc += 5;
+                        break;
+                    }
+                }else{
+                    rc = vm_target(lisp, a, &function, &code);
+                    if(rc) break;
+                    if(code != TL_BAD_CODE){
+                        /* Same errors as the tree walker before the
+                         * arguments are evaluated. */
+                        site = bc->sites+a;
+                        if(site->childnum < VAR_LEN((Var*)function->params)){
+                            rc = TL_ERR_TOO_FEW_ARGS;
+                        }else if(site->childnum >
+                                 VAR_LEN((Var*)function->params)){
+                            rc = TL_ERR_TOO_MANY_ARGS;
+                        }
+                        pc += 5;
+                        break;
+                    }
+                }
+                rc = vm_fallback(lisp, a, &pc);
+                break;
+            case TL_OP_BUILTIN:
+                rc = vm_builtin(lisp, a);
+                pc += 5;
+                break;
+            case TL_OP_CALL:
+                rc = vm_call(lisp, a, &pc);
+                break;
+            case TL_OP_TAILCALL:
+                rc = vm_target(lisp, a, &function, &code);
+                if(rc) break;
+                if(code == TL_BAD_CODE){
+                    /* It is not a user defined function anymore, so it is
+                     * called from the tree. */
+                    rc = vm_fallback(lisp, a, &pc);
+                    break;
+                }
+                site = bc->sites+a;
+                rc = call_rebind(lisp, site->childs, site->childnum, function,
+                                 bc->thunks+site->thunks);
+                pc = code;
+                break;
+            case TL_OP_EVAL:
+                rc = call_eval(lisp, bc->sites[a].node, &value);
+                if(!rc) rc = vm_push(lisp, &value);
+                pc += 5;
+                break;
+            case TL_OP_JUMP:
+                pc = a;
+                break;
+            case TL_OP_JUMPIFNOT:
+                /* Same checks as if and callif. */
+                value = lisp->values[--lisp->values_cur];
+                if(VAR_LEN(&value) != 1){
+                    rc = TL_ERR_INVALID_LIST_SIZE;
+                }else if(!VAR_IS_NUMBER(&value)){
+                    rc = TL_ERR_BAD_TYPE;
+                }else{
+                    pc = VAR_IS_TRUE(&value) ? pc+5 : a;
+                }
+                var_free(&value);
+                break;
+            case TL_OP_RETURN:
+                rc = vm_return(lisp, &pc, &done);
+                break;
+            case TL_OP_FOLDED:
+                if(bc->sites[a].fold_epoch == lisp->fold_epoch){
+                    pc += 5;
+                    break;
+                }
+                rc = vm_fallback(lisp, a, &pc);
+                break;
+            default:
+                rc = TL_ERR_INTERNAL;
+        }
+        if(rc){
+            vm_unwind(lisp, root, start);
+            return rc;
+        }
+    }
+    lisp->conts_cur = root;
+    *returned = lisp->values[--lisp->values_cur];
+    return TL_SUCCESS;
+}
+
+int vm_push(LizyLang *lisp, Var *value) {
+    int rc;
+    rc = call_value(lisp, value);
+    if(rc) var_free(value);
+    return rc;
+}
+
+int vm_target(LizyLang *lisp, size_t site, Function **function,
+              size_t *code) {
+    Site *called = lisp->bc.sites+site;
+    Node *fncdef;
+    int rc;
+    rc = call_find(lisp, called->node, called->symbol, function);
+    if(rc) return rc;
+    if((*function)->builtin){
+        *code = TL_BAD_CODE;
+        return TL_SUCCESS;
+    }
+    /* The body is compiled when the function is called for the first
+     * time, once its parameters are resolved. */
+    fncdef = (*function)->ptr.fncdef;
+    if(fncdef->code == TL_NO_CODE){
+        rc = compile_body(lisp, fncdef, code);
+        if(rc) return rc;
+    }
+    *code = fncdef->code;
+    return TL_SUCCESS;
+}
+
+int vm_fallback(LizyLang *lisp, size_t site, size_t *pc) {
+    Site *called = lisp->bc.sites+site;
+    Node call;
+    Var call_var;
+    Item call_item;
+    Var value;
+    Function *function;
+    int rc;
+    if(called->callif){
+        /* Do what callif does once the condition is true. */
+        rc = call_find(lisp, called->node, called->symbol, &function);
+        if(rc) return rc;
+        call_item.call.function = called->symbol;
+        call_item.call.has_func = 1;
+        call_var.type = TL_T_CALL;
+        call_var.items = &call_item;
+        call_var.size = 1;
+        call_var.null = 0;
+        node_init(&call, &call_var);
+        call.childs = called->childs;
+        call.childnum = called->childnum;
+        call.parent = called->callif->parent;
+        call.line = called->callif->line;
+        lisp->next = NULL;
+        lisp->tail_function = NULL;
+        rc = call_function(lisp, &call, function, &value);
+        if(!rc && (lisp->next || lisp->tail_function)){
+            rc = call_eval_pending(lisp, &value);
+        }
+    }else{
+        rc = call_eval(lisp, called->node, &value);
+    }
+    if(rc) return rc;
+    *pc = lisp->bc.sites[site].end;
+    return vm_push(lisp, &value);
+}
+
+int vm_param(LizyLang *lisp, size_t slot, size_t *pc) {
+    Cont *cont;
+    Var value;
+    size_t arg, context;
+    int rc;
+    if(!lisp->context) return TL_ERR_INTERNAL;
+    arg = lisp->stack[lisp->context-1].args+slot;
+    if(!lisp->args[arg].evaluated && lisp->args[arg].code != TL_NO_CODE){
+        /* Run the code of the argument in the context of the caller. */
+        rc = call_cont(lisp, TL_K_VFORCE, lisp->context, &cont);
+        if(rc) return rc;
+        cont->base = arg;
+        cont->i = *pc+5;
+        lisp->context = lisp->args[arg].context;
+        *pc = lisp->args[arg].code;
+        return TL_SUCCESS;
+    }
+    if(!lisp->args[arg].evaluated){
+        context = lisp->context;
+        lisp->context = lisp->args[arg].context;
+        rc = call_eval(lisp, lisp->args[arg].node, &value);
+        lisp->context = context;
+        if(rc) return rc;
+        lisp->args[arg].value = value;
+        lisp->args[arg].evaluated = 1;
+    }
+    rc = var_copy(&lisp->args[arg].value, &value);
+    if(rc) return rc;
+    *pc += 5;
+    return vm_push(lisp, &value);
+}
+
+int vm_builtin(LizyLang *lisp, size_t site) {
+    Site *called = lisp->bc.sites+site;
+    Function function = called->function;
+    Function *old_function;
+    Node *old_node;
+    size_t old_base, base, i;
+    Var value;
+    int rc;
+    base = lisp->values_cur-called->childnum;
+    old_function = lisp->eval_function;
+    old_node = lisp->eval_node;
+    old_base = lisp->eval_base;
+    lisp->eval_function = &function;
+    lisp->eval_node = called->node;
+    lisp->eval_base = base;
+    lisp->next = NULL;
+    lisp->tail_function = NULL;
+    rc = function.ptr.f(lisp, called->node, called->childnum, &value);
+    lisp->eval_function = old_function;
+    lisp->eval_node = old_node;
+    lisp->eval_base = old_base;
+    for(i=base;i<lisp->values_cur;i++){
+        var_free(lisp->values+i);
+    }
+    lisp->values_cur = base;
+    if(rc) return rc;
+    if(lisp->next || lisp->tail_function){
+        rc = call_eval_pending(lisp, &value);
+        if(rc) return rc;
+    }
+    return vm_push(lisp, &value);
+}
+
+int vm_call(LizyLang *lisp, size_t site, size_t *pc) {
+    Site *called;
+    Function *function;
+    Cont *cont;
+    Arg *args;
+    size_t code, i;
+    int rc;
+    rc = vm_target(lisp, site, &function, &code);
+    if(rc) return rc;
+    if(code == TL_BAD_CODE) return vm_fallback(lisp, site, pc);
+    called = lisp->bc.sites+site;
+    rc = call_push(lisp, called->childs, called->childnum, function);
+    if(rc) return rc;
+    args = lisp->args+lisp->args_cur-called->childnum;
+    for(i=0;i<called->childnum;i++){
+        args[i].code = lisp->bc.thunks[called->thunks+i];
+    }
+    rc = call_cont(lisp, TL_K_CODE, lisp->context, &cont);
+    if(rc){
+        call_pop(lisp);
+        return rc;
+    }
+    cont->i = *pc+5;
+    *pc = code;
+    return TL_SUCCESS;
+}
+
+int vm_return(LizyLang *lisp, size_t *pc, char *done) {
+    Cont *cont;
+    Arg *arg;
+    int rc;
+    cont = lisp->conts+lisp->conts_cur-1;
+    switch(cont->type){
+        case TL_K_CODE:
+            call_pop(lisp);
+            *pc = cont->i;
+            break;
+        case TL_K_VFORCE:
+            /* Keep the value of the argument for the next time. */
+            arg = lisp->args+cont->base;
+            rc = var_copy(lisp->values+lisp->values_cur-1, &arg->value);
+            if(rc) return rc;
+            arg->evaluated = 1;
+            lisp->context = cont->context;
+            *pc = cont->i;
+            break;
+        case TL_K_VROOT:
+            lisp->context = cont->context;
+            *done = 1;
+            break;
+        default:
+            return TL_ERR_INTERNAL;
+    }
+    lisp->conts_cur--;
+    return TL_SUCCESS;
+}
+
+void vm_unwind(LizyLang *lisp, size_t root, size_t pc) {
+    Cont *cont;
+    size_t i, line;
+    /* Like call_unwind, the line is the one of the statement of the
+     * outermost function that was running, and the frames are removed. */
+    while(lisp->conts_cur > root){
+        cont = lisp->conts+lisp->conts_cur-1;
+        switch(cont->type){
+            case TL_K_CODE:
+                if(!bc_find_line(&lisp->bc, pc, &line)) lisp->line = line;
+                pc = cont->i-1;
+                call_pop(lisp);
+                break;
+            case TL_K_VFORCE:
+                lisp->context = cont->context;
+                pc = cont->i-1;
+                break;
+            case TL_K_VROOT:
+                lisp->context = cont->context;
+                for(i=cont->base;i<lisp->values_cur;i++){
+                    var_free(lisp->values+i);
+                }
+                lisp->values_cur = cont->base;
+                break;
+        }
+        lisp->conts_cur--;
+    }
+    lisp->next = NULL;
+    lisp->tail_function = NULL;
+}
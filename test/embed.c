@@ -0,0 +1,166 @@
+/* A small interpreter for a lisp like language, targetting embedded systems.
+ * by Mibi88
+ *
+ * This software is licensed under the BSD-3-Clause license:
+ *
+ * Copyright 2024 Mibi88
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* CHANGELOG
+ *
+ * 2026/10/18: Created this file.
+ */
+
+/* Runs a program that fails many times in the same interpreter, with the
+ * virtual machine and the tree walker, and checks that the interpreter can
+ * still run code afterwards. Then checks that malformed programs are
+ * rejected before they run. Build it from the root of the repository:
+ *
+ * cc test/embed.c src/lisp.c src/var.c src/platform.c src/call.c \
+ *    src/builtin.c src/tree.c src/table.c src/symbol.c src/bytecode.c \
+ *    src/compile.c src/vm.c src/lex.c src/program.c src/optimize.c \
+ *    src/number.c -o embed -ansi -Isrc -lm
+ */
+
+#include <lisp.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUNS 300
+
+size_t errors = 0;
+size_t written = 0;
+
+void onerror(char *message, void *data) {
+    TL_UNUSED(message);
+    TL_UNUSED(data);
+    errors++;
+}
+
+size_t count(char *data, size_t len, void *user) {
+    TL_UNUSED(data);
+    TL_UNUSED(user);
+    written += len;
+    return len;
+}
+
+/* Compiles code and runs it in lisp, returns the error of tl_exec. */
+int exec(LizyLang *lisp, char *code) {
+    Program program;
+    int rc;
+    rc = tl_compile(lisp, code, strlen(code), &program, onerror, lisp);
+    if(rc) return rc;
+    rc = tl_exec(lisp, &program, onerror, lisp);
+    program_free(&program);
+    return rc;
+}
+
+int test(char bytecode) {
+    LizyLang lisp;
+    size_t i;
+    int rc;
+    tl_init(&lisp, NULL, 0);
+    tl_set_bytecode(&lisp, bytecode);
+    rc = exec(&lisp, "(fncdef f (params x) (g x))");
+    for(i=0;!rc && i<RUNS;i++){
+        if(exec(&lisp, "(f 1)") != TL_ERR_FUNC_NOT_DEF) rc = 1;
+        /* The frames of the call that failed are removed. */
+        if(lisp.stack_cur || lisp.args_cur || lisp.context) rc = 1;
+    }
+    if(!rc) rc = exec(&lisp, "(fncdef g (params y) (+ y 1))(f 1)");
+    if(!rc && errors != RUNS) rc = 1;
+    tl_free(&lisp);
+    errors = 0;
+    return rc;
+}
+
+/* Saves program for code and checks it, returns the error of
+ * program_check. */
+int check(Program *program, char *code) {
+    Program saved;
+    FILE *fp;
+    char *data;
+    long sz;
+    int rc;
+    fp = tmpfile();
+    if(!fp) return TL_ERR_INTERNAL;
+    rc = program_save(program, code, strlen(code), fp);
+    sz = ftell(fp);
+    data = malloc(sz > 0 ? sz : 1);
+    if(!rc && (sz < 0 || !data)) rc = TL_ERR_INTERNAL;
+    if(!rc){
+        rewind(fp);
+        if(fread(data, 1, sz, fp) != (size_t)sz) rc = TL_ERR_INTERNAL;
+    }
+    if(!rc) rc = program_check(data, sz, code, strlen(code), &saved);
+    free(data);
+    fclose(fp);
+    return rc;
+}
+
+/* A program that ends a call that was not started, or that does not end
+ * all its calls, is rejected without running any statement. */
+int test_malformed(void) {
+    LizyLang lisp;
+    Program program;
+    char *code = "(print \"Before\")(print \"After\")";
+    int rc;
+    tl_init(&lisp, NULL, 0);
+    tl_set_writer(&lisp, count, NULL);
+    rc = tl_compile(&lisp, code, strlen(code), &program, onerror, &lisp);
+    if(!rc) rc = check(&program, code);
+    if(!rc){
+        program_close(&program);
+        if(check(&program, code) != TL_ERR_BAD_INPUT) rc = 1;
+        if(tl_exec(&lisp, &program, onerror, &lisp) != TL_ERR_BAD_INPUT){
+            rc = 1;
+        }
+        /* The last call does not end anymore. */
+        program.len -= 2;
+        if(check(&program, code) != TL_ERR_BAD_INPUT) rc = 1;
+        if(tl_exec(&lisp, &program, onerror, &lisp) != TL_ERR_BAD_INPUT){
+            rc = 1;
+        }
+        program_free(&program);
+    }
+    if(written) rc = 1;
+    tl_free(&lisp);
+    return rc;
+}
+
+int main(void) {
+    if(test(1) || test(0) || test_malformed()){
+        puts("Failed!");
+        return EXIT_FAILURE;
+    }
+    puts("OK");
+    return EXIT_SUCCESS;
+}